@@ -0,0 +1,144 @@
+/* arena.h
+**
+**	Author: Adam Maulis
+**	2026.10.17
+**	Copyright: GNU AGPL v3 or newer
+**
+**
+**	Description: one anonymous memory arena for the io buffers, on 4 KiB,
+**	2 MiB or 1 GiB pages, optionally bound to a NUMA node, and where its
+**	pages really are; data type & member functions
+**
+**	The arena is only reserved by arena_create(), the pages come with the
+**	first touch (on the bound node, or on the node of the toucher). The
+**	hugetlb pages have to be reserved before (vm.nr_hugepages or the
+**	hugepages-1048576kB pool), without them the arena falls back to 4 KiB
+**	pages with MADV_HUGEPAGE (transparent hugepages, if the kernel wants).
+**	The NUMA calls are the raw syscalls, no libnuma.
+**
+**	Build notes:
+**	header only, used by fillone.c
+*/
+
+#ifndef __ARENA_H
+#define __ARENA_H
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <linux/mempolicy.h>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#define ARENA_2M ( 21 << MAP_HUGE_SHIFT )
+#define ARENA_1G ( 30 << MAP_HUGE_SHIFT )
+#define ARENA_MAXNODES 64
+#define ARENA_SAMPLES 4096	/* pages asked by arena_nodes() at most */
+
+typedef struct {
+		char * base;
+		size_t size;		/* multiple of pagesize */
+		size_t pagesize;	/* 4096, 2 MiB or 1 GiB: what it got */
+		int fallback;		/* hugetlb was asked, but 4 KiB pages (+THP) are used */
+		int node;		/* bound to, -1: first touch */
+	} arena_t;
+
+/*
+** pagesize: 4096, 2 MiB or 1 GiB, node: -1 for no binding
+** returns 0 or -errno
+*/
+static inline int arena_create( arena_t * a, size_t size, size_t pagesize, int node )
+{
+	unsigned long mask[ARENA_MAXNODES / ( 8 * sizeof(unsigned long) )];
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+	memset( a, 0, sizeof(*a) );
+	a->node = node;
+	a->pagesize = pagesize;
+	a->size = ( size + pagesize - 1 ) / pagesize * pagesize;
+	if( 4096 < pagesize )
+		flags |= MAP_HUGETLB | ( ( 1UL << 30 ) == pagesize ? ARENA_1G : ARENA_2M );
+	a->base = (char *)mmap(NULL, a->size, PROT_READ | PROT_WRITE, flags, -1, 0);
+	if( MAP_FAILED == a->base && 4096 < pagesize ){ /* no hugetlb pool */
+		a->fallback = 1;
+		a->pagesize = 4096;
+		a->size = ( size + 4095 ) / 4096 * 4096;
+		a->base = (char *)mmap(NULL, a->size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if( MAP_FAILED != a->base ) madvise(a->base, a->size, MADV_HUGEPAGE);
+	}
+	if( MAP_FAILED == a->base ){
+		a->base = NULL;
+		return -errno;
+	}
+	if( 0 <= node ){
+		if( ARENA_MAXNODES <= node ) return -EINVAL;
+		memset( mask, 0, sizeof(mask) );
+		mask[node / ( 8 * sizeof(unsigned long) )] |= 1UL << ( node % ( 8 * sizeof(unsigned long) ) );
+		if( syscall(SYS_mbind, a->base, a->size, MPOL_BIND, mask, ARENA_MAXNODES + 1, 0) )
+			return -errno;
+	}
+	return 0;
+}
+
+/*
+** where the touched pages are: count[node] pages out of at most
+** ARENA_SAMPLES evenly spread pages, returns the number of the sampled
+** pages that are present, or -errno
+*/
+static inline long arena_nodes( const arena_t * a, unsigned long * count )
+{
+	void * pages[ARENA_SAMPLES];
+	int status[ARENA_SAMPLES];
+	size_t npages, step, i, n;
+	long present = 0;
+
+	memset( count, 0, ARENA_MAXNODES * sizeof(unsigned long) );
+	npages = a->size / a->pagesize;
+	step = ( npages + ARENA_SAMPLES - 1 ) / ARENA_SAMPLES;
+	for( n = i = 0; i < npages; i += step )
+		pages[n++] = a->base + i * a->pagesize;
+	if( syscall(SYS_move_pages, 0, n, pages, NULL, status, 0) )
+		return -errno;
+	for( i = 0; i < n; i++ ){
+		if( 0 > status[i] || ARENA_MAXNODES <= status[i] ) continue; /* not touched */
+		count[status[i]]++;
+		present++;
+	}
+	return present;
+}
+
+/*
+** NUMA node of the device of a block device or of a file (its filesystem),
+** from sysfs, -1 if unknown
+*/
+static inline int arena_devnode( const char * path )
+{
+	struct stat st;
+	char fn[128];
+	FILE * f;
+	dev_t dev;
+	int node = -1, i;
+
+	if( stat(path, &st) ) return -1;
+	dev = S_ISBLK(st.st_mode) ? st.st_rdev : st.st_dev;
+	for( i = 0; i < 2 && -1 == node; i++ ){ /* the disk, then the disk of the partition */
+		snprintf(fn, sizeof(fn), "/sys/dev/block/%u:%u/%sdevice/numa_node",
+			major(dev), minor(dev), i ? "../" : "");
+		f = fopen(fn, "r");
+		if( NULL == f ) continue;
+		if( 1 != fscanf(f, "%d", &node) ) node = -1;
+		fclose(f);
+	}
+	return node;
+}
+
+#endif /* __ARENA_H */
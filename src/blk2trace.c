@@ -0,0 +1,245 @@
+/*
+ * Author: Maulis Adam
+ * Description:
+ *    blkparse output -> trace for the replay of fillone (-P)
+ *
+ *    The ios are taken at the issue (D) events, the original latency is
+ *    the time from the issue to the completion (C) of the same sector.
+ *    Discards, flushes and the other events are skipped. The records go
+ *    out in issue order, when they are completed (or lost: no completion
+ *    in 10 seconds, then the latency is unknown).
+ *
+ * initial release: 17-oct-2026
+ *
+ * to build:
+ * cc -O2 -o blk2trace -Wall blk2trace.c
+ *
+ * usage:
+ * blktrace -d /dev/sdb -o - | blkparse -i - | blk2trace [-c] [-Q] [-d8,16] > sdb.trace
+
+ Copyright by Adam Maulis 2026
+
+ This program is free software: you can redistribute it and/or modify it under
+ the terms of the GNU Affero General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ See the GNU Affero General Public License for more details.
+
+ */
+
+#define VERS "0.1"  /* update please! */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+#ifndef TRUE
+#define TRUE (0==0)
+#endif
+#ifndef FALSE
+#define FALSE (0!=0)
+#endif
+#define SECTOR 512ULL
+#define MAXPENDING (1 << 20)	/* ios in flight, power of 2 */
+#define HASHSIZE (1 << 20)	/* power of 2 */
+#define LOSTNS 10000000000ULL	/* no completion in this time: lost */
+
+/* one issued io, waiting for its completion */
+struct pending {
+	trace_rec_t rec;
+	unsigned dev;
+	unsigned long long sector;
+	int done;
+	long next;	/* in the hash chain, -1: end */
+};
+
+static struct {
+	int csv;
+	int queue;	/* Q instead of D marks the issue */
+	int devset;
+	unsigned dev;
+	struct pending * fifo;	/* ring, in issue order */
+	unsigned long long head, tail;	/* sequence numbers */
+	long * hash;	/* first fifo index of the chain, -1: empty */
+	unsigned long long records, lost, unmatched;
+}opt;
+
+static inline unsigned long hashkey(unsigned dev, unsigned long long sector)
+{
+	return (unsigned long)( ( sector * 0x9E3779B97F4A7C15ULL ) ^ dev ) >> 12 & ( HASHSIZE - 1 );
+}
+
+void emit(const trace_rec_t * r)
+{
+	int status;
+
+	if( opt.csv )
+		status = 0 > printf("%.9f,%llu,%u,%c,%.3f\n", (double)r->ns / 1e9,
+			(unsigned long long)r->offset, r->len,
+			TRACE_READ == r->op ? 'R' : 'W', (double)r->latns / 1e3) ? -EIO : 0;
+	else
+		status = trace_write(stdout, r);
+	if( status ){
+		perror("Error: cannot write the trace");
+		exit(1);
+	}
+	opt.records++;
+}
+
+/* removes fifo[idx] from its hash chain */
+void unhash(long idx)
+{
+	long * pp;
+
+	pp = &opt.hash[hashkey(opt.fifo[idx].dev, opt.fifo[idx].sector)];
+	while( -1 != *pp && *pp != idx )
+		pp = &opt.fifo[*pp].next;
+	if( -1 != *pp ) *pp = opt.fifo[idx].next;
+}
+
+/* the completed (or lost, or all if force) ios from the head of the fifo */
+void flush(unsigned long long nowns, int force)
+{
+	struct pending * p;
+
+	while( opt.head < opt.tail ){
+		p = &opt.fifo[opt.head & (MAXPENDING - 1)];
+		if( ! p->done ){
+			if( ! force && p->rec.ns + LOSTNS > nowns && opt.tail - opt.head < MAXPENDING )
+				break;
+			unhash(opt.head & (MAXPENDING - 1));
+			opt.lost++;
+		}
+		emit(&p->rec);
+		opt.head++;
+	}
+}
+
+void issue(unsigned dev, double sec, int op, unsigned long long sector, unsigned long long nsect)
+{
+	struct pending * p;
+	long idx;
+	unsigned long h;
+
+	flush((unsigned long long)(sec * 1e9), FALSE);
+	idx = opt.tail & (MAXPENDING - 1);
+	p = &opt.fifo[idx];
+	p->rec.ns = (uint64_t)(sec * 1e9 + 0.5);
+	p->rec.offset = sector * SECTOR;
+	p->rec.len = (uint32_t)(nsect * SECTOR);
+	p->rec.op = op;
+	p->rec.latns = 0;
+	p->dev = dev;
+	p->sector = sector;
+	p->done = FALSE;
+	h = hashkey(dev, sector);
+	p->next = opt.hash[h];
+	opt.hash[h] = idx;
+	opt.tail++;
+}
+
+void complete(unsigned dev, double sec, unsigned long long sector)
+{
+	long idx;
+	unsigned long long ns = (unsigned long long)(sec * 1e9 + 0.5);
+
+	for( idx = opt.hash[hashkey(dev, sector)]; -1 != idx; idx = opt.fifo[idx].next ){
+		if( opt.fifo[idx].dev == dev && opt.fifo[idx].sector == sector && ! opt.fifo[idx].done )
+			break;
+	}
+	if( -1 == idx ){ /* issued before the trace started */
+		opt.unmatched++;
+		return;
+	}
+	unhash(idx);
+	opt.fifo[idx].done = TRUE;
+	opt.fifo[idx].rec.latns = ns > opt.fifo[idx].rec.ns ? ns - opt.fifo[idx].rec.ns : 0;
+	flush(ns, FALSE);
+}
+
+void puthelp(void)
+{
+	fprintf(stderr,"blk2trace version %s copyright by Maulis Adam 2026, using AGPL v3 or newer\n\n", VERS);
+	fprintf(stderr,"Usage: blkparse ... | blk2trace [options] > tracefile\n");
+	fprintf(stderr,"   -c csv output (the default is binary)\n");
+	fprintf(stderr,"   -Q the queue (Q) events are the issues, not the driver issues (D)\n");
+	fprintf(stderr,"   -dmaj,min only this device\n");
+}
+
+int main(int argc, char* argv[])
+{
+	int optarg;
+	char line[1024];
+	char rwbs[16];
+	char action;
+	unsigned maj, min, dev;
+	int cpu, pid, op;
+	unsigned long seq;
+	double sec;
+	unsigned long long sector, nsect;
+	long i;
+
+	for(optarg=1;  optarg < argc && argv[optarg][0] == '-'; optarg++ ){
+		switch( argv[optarg][1] ){
+			case 'c': opt.csv = TRUE;
+				break;
+			case 'Q': opt.queue = TRUE;
+				break;
+			case 'd': if( 2 != sscanf(argv[optarg]+2, "%u,%u", &maj, &min) ){
+					fprintf(stderr,"Invalid device: %s\n", argv[optarg]+2);
+					return 1;
+				  }
+				  opt.dev = maj << 20 | min;
+				  opt.devset = TRUE;
+				break;
+			default: fprintf(stderr,"Unknown opt: %s\n", argv[optarg]);
+				puthelp();
+				return 1;
+		}
+	}
+	if( optarg < argc ){
+		puthelp();
+		return 1;
+	}
+
+	opt.fifo = (struct pending *)malloc(MAXPENDING * sizeof(struct pending));
+	opt.hash = (long *)malloc(HASHSIZE * sizeof(long));
+	if( NULL == opt.fifo || NULL == opt.hash ){
+		fprintf(stderr,"Error: no memory\n");
+		return 1;
+	}
+	for( i = 0; i < HASHSIZE; i++ )
+		opt.hash[i] = -1;
+	if( ! opt.csv && trace_writeheader(stdout) ){
+		perror("Error: cannot write the trace");
+		return 1;
+	}
+
+	/* "  8,16   1       12     0.000251231  4242  D   W 2048 + 256 [fio]" */
+	while( NULL != fgets(line, sizeof(line), stdin) ){
+		if( 10 != sscanf(line, "%u,%u %d %lu %lf %d %c %15s %llu + %llu",
+				&maj, &min, &cpu, &seq, &sec, &pid, &action, rwbs, &sector, &nsect) )
+			continue; /* the summary and the other event formats */
+		dev = maj << 20 | min;
+		if( opt.devset && dev != opt.dev ) continue;
+		if( NULL != strchr(rwbs, 'D') ) continue; /* discard */
+		if( NULL != strchr(rwbs, 'W') ) op = TRACE_WRITE;
+		else if( NULL != strchr(rwbs, 'R') ) op = TRACE_READ;
+		else continue; /* flush and the others */
+		if( 0 == nsect ) continue;
+		if( ( opt.queue ? 'Q' : 'D' ) == action )
+			issue(dev, sec, op, sector, nsect);
+		else if( 'C' == action )
+			complete(dev, sec, sector);
+	}
+	flush(0, TRUE);
+	fflush(stdout);
+	fprintf(stderr, "blk2trace: %llu records, %llu without completion, "
+		"%llu completions without issue\n", opt.records, opt.lost, opt.unmatched);
+	return 0;
+}
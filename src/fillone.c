@@ -17,11 +17,38 @@
  *		17-oct-2016, Maulis, non-compressable (/dev/urandom) 64k fill 
  *		20-nov-2018, Maulis, parameter selectable compressable/noncompressable pattern
  *      13-aug-2024, Maulis, output jsonify
+ *      17-oct-2026, Maulis, per-io latency histogram, percentiles in the output
+ *      17-oct-2026, Maulis, io engines: aio and io_uring
+ *      17-oct-2026, Maulis, userspace prng with seed, offset distributions
+ *      17-oct-2026, Maulis, worker threads (-j) with own io contexts, cpu pinning
+ *      17-oct-2026, Maulis, time based runs, interval reports as json lines
+ *      17-oct-2026, Maulis, open loop (rate limited) mode
+ *      17-oct-2026, Maulis, mixed read/write phase
+ *      17-oct-2026, Maulis, all the selected phases run, json array output
+ *      17-oct-2026, Maulis, blocksize x threadcount sweep with knee point
+ *      17-oct-2026, Maulis, pattern generator with compression and dedup ratio
+ *      17-oct-2026, Maulis, read verification in the completion path
+ *      17-oct-2026, Maulis, more targets (striped or random), per target stats
+ *      17-oct-2026, Maulis, block trace replay (see blk2trace.c for the traces)
+ *      17-oct-2026, Maulis, blocksize distribution (bssplit), offset alignment
+ *      17-oct-2026, Maulis, interleaved flushes and discards, their own stats
+ *      17-oct-2026, Maulis, polled completions (aio ring in userspace, uring iopoll), job cpu
+ *      17-oct-2026, Maulis, rusage and perf counters of the run in the output
+ *      17-oct-2026, Maulis, per io binary log by a writer thread (see iologstat.c)
+ *      17-oct-2026, Maulis, preconditioning with steady state detection
+ *      17-oct-2026, Maulis, more sequential streams per job, per stream stats
+ *      17-oct-2026, Maulis, filesystem metadata workload (create/write/fsync/rename/stat/unlink)
+ *      17-oct-2026, Maulis, mmap and psync (buffered, fadvise) engines, page faults in the output
+ *      17-oct-2026, Maulis, zoned block devices: writes at the write pointers, per zone stats
+ *      17-oct-2026, Maulis, buffer arena on hugepages, bound to a numa node, placement in the output
+ *      17-oct-2026, Maulis, batched submits and reaps, low watermark refill, syscalls per io in the output
  *
  * to build:
  * 
  * apt-get install libaio-dev
- * cc -o fillone -Wall fillone.c -laio
+ * cc -O2 -o fillone -Wall fillone.c -laio -lm -lpthread
+ * (-O2 or more: the pattern generator is vectorized by gcc, about 5GB/s per core)
+ * (the io_uring engine uses the raw syscalls: linux >= 5.6, no liburing)
 
  Copyright by Adam Maulis 2024
 
@@ -40,22 +67,41 @@
 #if !defined(__x86_64__)
 #error "64 bit architecture only *"
 #endif
-#define VERS "0.11"  /* update please! */
+#define VERS "0.36"  /* update please! */
 #define _GNU_SOURCE  /* for O_DIRECT constanst */
 #define _LARGEFILE64_SOURCE
 #include <inttypes.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <time.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/sysmacros.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
 #include <linux/fs.h> /* block device get size ioctl */
 #include <libaio.h> /* io_submit/io_setup/io_destroy/io_getevents */
+#include "lathist.h"
+#include "uring.h"
+#include "pattern.h"
+#include "trace.h"
+#include "perfcnt.h"
+#include "iolog.h"
+#include "zoned.h"
+#include "arena.h"
+#include "meeting.h"
 
 #define MAGIC 0xDEADBEEF
 #ifndef TRUE
@@ -68,19 +114,150 @@
 
 #define RANDOMPOOL "/dev/urandom"
 
+/* offset distributions of the random tests */
+#define DIST_UNIFORM 0
+#define DIST_ZIPF 1
+#define DIST_HOT 2
+
+/* io directions, index of the per direction statistics */
+#define DIR_READ 0
+#define DIR_WRITE 1
+
+/* slot operations: the data ios and the interleaved durability ops */
+#define OP_RW 0
+#define OP_FLUSH 1
+#define OP_DISCARD 2
+
+/* ops of the metadata workload (-f), index of their statistics */
+#define MOP_CREATE 0
+#define MOP_WRITE 1
+#define MOP_FSYNC 2
+#define MOP_RENAME 3
+#define MOP_STAT 4
+#define MOP_UNLINK 5
+#define MOP_N 6
+#define MFILE_BLOCKS 16 /* -f: the writes wrap around in the files at this many blocks */
+
+#define SWEEP_MAX 32 /* max. number of blocksizes and threadcounts of a sweep */
+#define BSS_MAX 16   /* max. number of the blocksize classes */
+#define IOLOG_RING (1 << 16)  /* per io log: records in the ring of a job */
+#define IOLOG_CHUNK (1 << 20) /* per io log: bytes of one write */
+
+struct ioengine;
+struct iojob;
+struct zone;
+
 static struct OPT {
 	int debug; /* for DEBUG envvar */
 	int rawmode;
 	int uncompressable;
+	double compress; /* pattern generator: target compression ratio, 0: off */
+	double dedup;    /* pattern generator: target dedup ratio, 0: off */
+	pattern_t pattern;
+	int verify;      /* check the read data */
+	char * dumpfile; /* verify: the first bad block goes here */
+	int dumped;      /* verify: the first bad block is reported */
+	unsigned long long badblocks; /* verify: of all the phases, for the exit code */
+	char * tracefile;   /* replay */
+	double replayspeed; /* replay: speedup of the timeline, 0: as fast as possible */
+	unsigned long long tracestart; /* replay: time of the first record */
+	unsigned long long maxreclen;
+	unsigned long long replayalign; /* replay: of the wrapped offsets */
+	unsigned long long bss[BSS_MAX];  /* bssplit: the blocksizes ... */
+	unsigned long long bsscum[BSS_MAX]; /* ... and the cumulated weights */
+	int nbss;        /* 0: every io is opt.mbl */
+	unsigned long long align; /* of the random offsets, 0: the blocksize */
+	const struct ioengine * engine;
+	int regbuf;  /* uring: registered buffers */
+	int regfile; /* uring: registered file */
+	int sqpoll;  /* uring: kernel side submission polling */
+	int iopoll;  /* uring: polled block io (IORING_SETUP_IOPOLL, O_DIRECT only) */
+	int poll;    /* busy polling of the completions instead of sleeping */
+	int populate;  /* mmap: MAP_POPULATE */
+	int madvice;   /* mmap: MADV_*, -1: none */
+	int fadvice;   /* psync: POSIX_FADV_*, -1: none */
+	int dropbehind; /* psync: POSIX_FADV_DONTNEED after every io */
+	unsigned long long readahead; /* psync: readahead() after every read, 0: off */
+	unsigned long long seed; /* of the userspace prng */
+	int dist;    /* DIST_* */
+	double zipftheta;
+	double hotio;   /* DIST_HOT: this fraction of the ios ... */
+	double hotarea; /* ... goes to this fraction of the device */
 	int rndfh; /* random pool file handle */
     char * randompool;
-	char * fname;
-	char * * buff; /* each thread has own buff */
-	long long threadcnt;
+	char * fname;   /* as it was given, for the messages */
+	char ** fnames; /* the targets */
+	int ntargets;
+	int targetrnd;  /* random target per io, default: striped */
+	long long threadcnt; /* outstanding ios per job */
+	int njobs;     /* worker threads */
+	int sharedrnd; /* random tests: every job uses the whole file */
+	int * cpus;    /* pin the jobs to these cpus */
+	int ncpus;
+	struct iojob * jobs;
+	meeting_t startmeet;
 	unsigned long long mbl;
+	unsigned long long blocksize; /* as it was given: with -b mbl is the mean io size */
 	unsigned long long datasize;
 	unsigned long long filesize;
 	unsigned long long totio;
+	unsigned long long runtimens; /* time based run, 0: until totio */
+	long intervalms; /* interval reports, 0: none */
+	double rate;     /* open loop: ios/sec of all the jobs, 0: closed loop */
+	int poisson;     /* open loop: poisson arrivals instead of fixed gaps */
+	int readpct;     /* mixed phase: percent of the reads */
+	int mixseqread;  /* mixed phase: sequential reads (default random) */
+	int mixseqwrite; /* mixed phase: sequential writes (default random) */
+	int dropcaches;  /* between the phases */
+	int phasesleep;  /* seconds between the phases */
+	unsigned long long bufsize; /* of one buffer: the largest blocksize */
+	long long nbufs;            /* per job: the largest threadcount */
+	unsigned long long sweepbs[SWEEP_MAX]; /* -B */
+	int nsweepbs;
+	unsigned long long sweepqd[SWEEP_MAX]; /* -Q */
+	int nsweepqd;
+	double kneepct;  /* sweep: the knee on this latency percentile, 0: on the mean */
+	unsigned long long flushn;     /* flush after this many writes, 0: off */
+	unsigned long long flushbytes; /* flush after this many written bytes, 0: off */
+	int flushfull;   /* fsync instead of fdatasync */
+	unsigned long long discardn;   /* discard after this many ios, 0: off */
+	unsigned long long discardlen; /* 0: the blocksize */
+	char * tgtblk;   /* per target: block device (BLKDISCARD instead of punch hole) */
+	int perfev[PERFCNT_MAX]; /* -H: perf counters of the jobs, index in perfcnt_events[] */
+	int nperfev;
+	char * iologfile;  /* -L: per io log, NULL: off */
+	int iologfd;
+	iolog_ring_t * iologrings; /* one per job, drained by the writer thread */
+	pthread_t iologtid;
+	int iologstop;
+	int phaseno;       /* number of the result object, in the log records */
+	int precond;       /* -W: preconditioning before the phases */
+	int pcfills;       /* full sequential writes */
+	unsigned long long pcroundns; /* random write rounds of this length ... */
+	int pcwindow;      /* ... until the last this many are steady, */
+	double pctol;      /* within this percent (the slope: within the half) */
+	int pcmax;         /* at most this many rounds */
+	int nstreams;      /* -N: sequential streams per job, 0: one cursor */
+	int streamrnd;     /* the streams start at random offsets, default: evenly spaced */
+	int meta;          /* -f: metadata workload in the target directory */
+	unsigned mopcum[MOP_N]; /* -f: cumulated weights of the ops */
+	unsigned mdirs;    /* -f: shared directories of the files */
+	unsigned long long mfiles; /* -f: files of a job before the start */
+	int mkeep;         /* -f: the files and the directories are not removed */
+	int zoned;         /* -z: the writes go to the write pointers of the zones */
+	int zopen;         /* -z: open zones per job, 0: the threadcount */
+	int zreset;        /* -z: the full zones are reset for the reuse */
+	struct zone * zones; /* -z: the sequential write zones, zone i belongs to job i % njobs */
+	long nzones;
+	int arena;         /* -a: the buffers of all the jobs are in bufarena */
+	size_t arenapage;  /* -a: 4 KiB, 2 MiB or 1 GiB */
+	int arenanode;     /* -a: bind to this node, -1: first touch, -2: the node of the device */
+	arena_t bufarena;
+	int devnode;       /* numa node of the (first) target, -1: unknown */
+	int batching;      /* -q given, for the output */
+	long batchsub;     /* -q: at most this many ios per submit, 0: all the prepared ones */
+	long batchcomp;    /* -q: the reap waits for this many completions (closed loop) */
+	long iolow;        /* -q: refill only when this many or less are in flight, -1: at once */
 }opt;
 
 
@@ -104,7 +281,7 @@ long long atoint64(const char *ca)
       return (ig*sign);
 }
 
-unsigned long long getfilesize()
+unsigned long long getfilesize(const char * fname)
 {
 	struct stat statit;
 	int fd;
@@ -112,15 +289,15 @@ unsigned long long getfilesize()
 	unsigned long int filesize32;
 	unsigned long long filesize;
 	
-	fd=open(opt.fname,O_RDONLY|O_LARGEFILE);
+	fd=open(fname,O_RDONLY|O_LARGEFILE);
 	if( -1 == fd ){
-		fprintf(stderr,"Cannot open %s", opt.fname);
+		fprintf(stderr,"Cannot open %s", fname);
 		perror(" ");
 		exit(1);
 	}
 	ret = fstat(fd, &statit);
 	if( -1 == ret ){
-		fprintf(stderr,"Cannot get size of %s", opt.fname);
+		fprintf(stderr,"Cannot get size of %s", fname);
 		perror(" ");
 		close(fd);
 		exit(1);
@@ -132,7 +309,7 @@ unsigned long long getfilesize()
 
         	ret = ioctl(fd, BLKGETSIZE, &filesize32);
         	if (ret){
-			fprintf(stderr,"Cannot get size of %s", opt.fname);
+			fprintf(stderr,"Cannot get size of %s", fname);
 			perror(" ");
                 	exit(1);
 		}
@@ -149,6 +326,22 @@ unsigned long long getfilesize()
 	return filesize;
 }
 
+/*
+ * the size of the area of the random tests: striped targets are like
+ * raid0, the smallest target limits
+ */
+unsigned long long gettargetsize()
+{
+	unsigned long long size, minsize = ~0ULL;
+	int t;
+
+	for( t = 0; t < opt.ntargets; t++ ){
+		size = getfilesize(opt.fnames[t]);
+		if( size < minsize ) minsize = size;
+	}
+	return opt.targetrnd ? minsize : minsize / opt.mbl * opt.mbl * opt.ntargets;
+}
+
 /*
  * error handling functions
  */
@@ -205,12 +398,12 @@ void errh_io_getevents( long result)
 	errh_iogeneric("io_getevents", result); 
 }
 
-void 	errh_ioerr(signed long long res, signed long long res2, int is_read)
+void 	errh_ioerr(signed long long res, signed long long res2, const char * what)
 {
 	if( res2 == 0 ) return;
 
 	fprintf(stderr, "Error: %lld=%s %s\n",
-		res, is_read ? "read()" : "write()", strerror(-res2));
+		res, what, strerror(-res2));
 	exit(1);
 }
 
@@ -228,335 +421,4027 @@ void debug_backpoint(int n)
 }
 
 /*
- * sub_doio
- * 	generate opt.theradcnt number of concurent io
- *
+ * monotonic clock in nanoseconds (vdso, no syscall)
  */
- 
-void sub_doio(int is_rand, int readflag)
+static inline unsigned long long now_ns(void)
 {
-	io_context_t ctx;
-	long result;
-	struct iocb ** iocbs, **listofiocb;
-	struct iocb * myiocbp;
-	struct io_event * events;
-	long i,needsubmit;
-	unsigned long long nextoffset;
-	unsigned long long rnd;
-	unsigned long long io_qd;
-	long iopending;
-	int fh;
-	struct timeval begint;
-	struct timeval endt;
-	unsigned long long ofs;
+	struct timespec ts;
 
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
 
-	if(opt.debug){fprintf(stdout,"\n sub_doio start: %s %s \n",
-			is_rand?"rnd":"seq",readflag==O_RDONLY?"read":"write"); 
-		fflush(stdout);}
+/* cpu time of the calling thread in nanoseconds */
+static inline unsigned long long thread_cpu_ns(void)
+{
+	struct timespec ts;
 
-	if(is_rand) opt.filesize=getfilesize();
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
 
-	memset( &ctx, 0, sizeof(ctx));
-	result = io_queue_init(opt.threadcnt, &ctx);
-	errh_iogeneric("io_queue_init", result );
+/*
+ * userspace random generator: xoshiro256**, seeded once by splitmix64.
+ * 	No syscall on the hot path, and the same seed gives the same offsets.
+ */
+struct rng {
+	uint64_t s[4];
+};
 
-	iocbs = (struct iocb **) calloc(opt.threadcnt , sizeof(struct iocb *));
-	errh_malloc(iocbs, "array1 of struct iocb");
-	listofiocb = (struct iocb **) calloc(opt.threadcnt , sizeof(struct iocb *));
-	errh_malloc(iocbs, "array2 of struct iocb");
-	for( i = 0; i< opt.threadcnt; i++){
-		listofiocb[i]=iocbs[i]=(struct iocb *)calloc(1,sizeof(struct iocb));
-		errh_malloc(iocbs[i], "one of struct iocb");
-	}
-	events = calloc(opt.threadcnt , sizeof( struct io_event));
-	errh_malloc(events, "array of struct io_events");
-	
-	fh=open(opt.fname, readflag |  O_LARGEFILE | opt.rawmode );
-	if( fh <0 ){
-		fprintf(stderr, "Error opening '%s'", opt.fname);
-		perror(" ");
-		exit(1) ;
-	}
+static inline uint64_t rotl64(uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
 
-	iopending = 0;
-	io_qd = 0;
-	nextoffset = 0;
-	for(i = 0; i < opt.threadcnt; i++){
-		if(is_rand){
-			read(opt.rndfh, &rnd, sizeof(rnd));
-			rnd &= 0x7FFFFFFFFFFFFFFFLL; /*offset is signed */
-			nextoffset = opt.mbl * (rnd % (opt.filesize/opt.mbl));
-		}
-		if(readflag==O_RDONLY){
-			io_prep_pread( iocbs[i],fh,opt.buff[i], opt.mbl,nextoffset);
-		}else{
-			if( opt.uncompressable ) {/* minden 4kiB hatarnal kellene offsetet beirni, 32 biten, ez 16TiB uniq */
-				for( ofs= 0 ; ofs<opt.mbl; ofs+=4096 )
-					*( (uint32_t *) (opt.buff[i]+ofs) ) = (nextoffset + ofs) >> 12;
-			}
-			io_prep_pwrite(iocbs[i],fh,opt.buff[i], opt.mbl,nextoffset);
-		}
-		nextoffset+=opt.mbl;
+static inline uint64_t rng_next(struct rng * r)
+{
+	uint64_t result = rotl64(r->s[1] * 5, 7) * 9;
+	uint64_t t = r->s[1] << 17;
+
+	r->s[2] ^= r->s[0];
+	r->s[3] ^= r->s[1];
+	r->s[1] ^= r->s[2];
+	r->s[0] ^= r->s[3];
+	r->s[2] ^= t;
+	r->s[3] = rotl64(r->s[3], 45);
+	return result;
+}
+
+void rng_seed(struct rng * r, uint64_t seed)
+{
+	int i;
+	uint64_t z;
+
+	for( i = 0; i < 4; i++){ /* splitmix64 */
+		z = (seed += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		r->s[i] = z ^ (z >> 31);
 	}
+}
 
-	gettimeofday(&begint, NULL);
-	/* kezdeti */
-	result = io_submit( ctx, opt.threadcnt, iocbs);
-	errh_io_submit(result);
-	io_qd += result;
-	iopending += result;
-	if(opt.debug==2)printf("\n %12lld %8ld  %ld\n", io_qd, result,iopending);
-	if(opt.debug==3)debug_putpoint(iopending);
+/* uniform in [0,n) without division */
+static inline uint64_t rng_below(struct rng * r, uint64_t n)
+{
+	return (uint64_t)( ((__uint128_t)rng_next(r) * n) >> 64 );
+}
 
-	do{
-		/* varakozas */
-		result = io_getevents( ctx, 1, opt.threadcnt, events, NULL);
-		errh_io_getevents(result);
-		iopending -= result;
-		if(opt.debug){
-			if(opt.debug==2)
-				printf(" %12lld %8ld  %ld\n", io_qd,-result,iopending);
-			if(opt.debug==3)debug_backpoint(result);
-		}
-		/* az a 'result' ami visszatert, a 'opt.totio-io_qd' ami hatravan.
-		 * minden viszatertet fel kell dolgozni, de csak a minimumot kell 
-		 * ujra elkuldeni.
-		*/
-		needsubmit=( result< (opt.totio-io_qd)) ? result : opt.totio-io_qd;
-		for(i =0; i < result; i++){ /* result == number of terminated events */
+/* uniform in [0,1) */
+static inline double rng_double(struct rng * r)
+{
+	return (double)(rng_next(r) >> 11) * (1.0 / 9007199254740992.0);
+}
 
-			myiocbp=events[i].obj; /* ez a hozza tartozo iocb */
-			errh_ioerr(events[i].res,events[i].res2,readflag==O_RDONLY);
+/*
+ * zipfian block selector (Gray et al.: Quickly generating billion-record
+ * synthetic databases). The ranks are scattered over the device by a
+ * multiplication with a prime modulo n, so the hot blocks are not all at
+ * the beginning.
+ */
+#define ZIPF_PRIME 18446744073709551557ULL /* 2^64-59 */
 
-			if( i<needsubmit ){
-			/* egyedi io */
-				if( is_rand){
-		                	read(opt.rndfh, &rnd, sizeof(rnd));
-		       	        	rnd &= 0x7FFFFFFFFFFFFFFFLL; /* aio_offset is signed */
-					nextoffset = opt.mbl * (rnd % (opt.filesize/opt.mbl));
-					myiocbp->u.c.offset = nextoffset;
-		        	}else{
-		                	myiocbp->u.c.offset = nextoffset;
-		                	nextoffset += opt.mbl;
-		        	}
-
-				if( opt.uncompressable ) {/* minden 4kiB hatarnal kellene offsetet beirni, 32 biten, ez 16TiB uniq */
-					for( ofs= 0 ; ofs<opt.mbl; ofs+=4096 )
-						*( (uint32_t *) (myiocbp->u.c.buf+ofs) ) = 
-							(myiocbp->u.c.offset + ofs) >> 12;
-				}
-				iocbs[i]=myiocbp; /* iocbs itt ujrahasznalhato? az aio masolja az iocb -t?*/
-			}
-		}
-		if( needsubmit){
-			result = io_submit( ctx, needsubmit, iocbs);
-			errh_io_submit(result);
-			io_qd+=needsubmit;
-			iopending+=needsubmit;
-			switch(opt.debug){
-				case 0: break;
-				case 2: printf(" %12lld %8ld  %ld\n",io_qd, 
-						needsubmit,iopending);
-					break;
-				case 3:	debug_putpoint(needsubmit);
-					break;
-				default:
-					if( 0 == ( (io_qd+1) % 65536 )) {
-						putchar('+'); 
-						fflush(stdout);
-					}
-					if( 0 == ( ((io_qd+1) * opt.mbl) & 0x3FFFFFFF )) {
-						printf(" %lldGiB ", ((io_qd+1)* opt.mbl)>>30);
-						fflush(stdout);
-					}
-			}
+struct zipf {
+	unsigned long long n;
+	double theta;
+	double alpha;
+	double zetan;
+	double eta;
+	double half_pow_theta;
+};
 
-		}	
+/* exact for the first million terms, integral approximation above */
+double zeta(unsigned long long n, double theta)
+{
+	double sum = 0.0;
+	unsigned long long i, k;
+
+	k = n < 1000000ULL ? n : 1000000ULL;
+	for( i = 1; i <= k; i++ )
+		sum += pow((double)i, -theta);
+	if( n > k )
+		sum += ( pow((double)n + 0.5, 1.0 - theta) - pow((double)k + 0.5, 1.0 - theta) ) 
+			/ (1.0 - theta);
+	return sum;
+}
 
-	}while( io_qd < opt.totio );
+void zipf_init(struct zipf * z, unsigned long long n, double theta)
+{
+	z->n = n;
+	z->theta = theta;
+	z->alpha = 1.0 / (1.0 - theta);
+	z->zetan = zeta(n, theta);
+	z->eta = (1.0 - pow(2.0 / (double)n, 1.0 - theta)) / 
+		(1.0 - zeta(2, theta) / z->zetan);
+	z->half_pow_theta = 1.0 + pow(0.5, theta);
+}
 
-	result = io_getevents( ctx, iopending, opt.threadcnt, events, NULL);
-	errh_io_getevents(result);
-	iopending -= result; 
-	if(opt.debug==2) printf(" %12lld %8ld  %ld\n", io_qd,-result,iopending);
-	
-	if( 0 != iopending ){
-		fprintf(stderr, "Error: %ld pending ios found (internal failure)\n",iopending);
-		exit(1);
+static inline unsigned long long zipf_next(const struct zipf * z, struct rng * r)
+{
+	double u, uz;
+	unsigned long long rank;
+
+	u = rng_double(r);
+	uz = u * z->zetan;
+	if( uz < 1.0 )
+		rank = 0;
+	else if( uz < z->half_pow_theta )
+		rank = 1;
+	else
+		rank = (unsigned long long)( (double)z->n * pow(z->eta * u - z->eta + 1.0, z->alpha) );
+	if( rank >= z->n ) rank = z->n - 1;
+	return (unsigned long long)( ((__uint128_t)rank * ZIPF_PRIME) % z->n );
+}
+
+/*
+ * io engines
+ * 	sub_doio() is engine neutral: it fills struct ioslot, the engine
+ * 	translates the slots to iocb (aio) or sqe (uring) on submit and
+ * 	gives them back on reap. Every engine function exits on error.
+ */
+struct ioslot {
+	struct iocb iocb;	/* aio engine only */
+	char * buf;
+	unsigned long long offset;
+	unsigned long long submitns;
+	long long res;		/* bytes or -errno, set by the reap */
+	long idx;
+	int isread;
+	int target;	/* index in opt.fnames */
+	unsigned long long devoffset; /* on the target */
+	unsigned len;	/* bytes, opt.mbl except the replay and the bssplit */
+	int bsclass;	/* bssplit: index in opt.bss */
+	int op;		/* OP_* */
+	int stream;	/* -N: index in job->streams, -1: random io */
+	long zone;	/* -z: index in opt.zones, -1: not a zone write */
+};
+
+/* for the error messages */
+static inline const char * slot_opname(const struct ioslot * slot)
+{
+	switch( slot->op ){
+		case OP_FLUSH: return opt.flushfull ? "fsync()" : "fdatasync()";
+		case OP_DISCARD: return "discard()";
+		default: return slot->isread ? "read()" : "write()";
 	}
-	
-	fsync(fh); /* az idomeres elott kell lennie, mert van buffer amit ekkor urit*/
+}
 
-	gettimeofday(&endt, NULL);
-    {
-        double elapsedtime;
+/* -N: one sequential stream of a job, it wraps from end to begin */
+struct stream {
+	unsigned long long begin;
+	unsigned long long end;
+	unsigned long long start;	/* the first offset */
+	unsigned long long next[2];	/* cursor of the reads and the writes */
+};
 
-        elapsedtime = ((double)endt.tv_sec - (double)begint.tv_sec +
-             ((double)endt.tv_usec - (double)begint.tv_usec)/1000000.0);
+/* -f: a file of a job is <target>/d<dir>/j<job>.<seq> */
+struct mfile {
+	unsigned dir;
+	unsigned long long seq;
+	unsigned long long nwrites; /* the next write goes to block nwrites % MFILE_BLOCKS */
+};
 
-        printf("\"elapsed\":%f, \"byteps\":%f, \"iops\":%f",
-             elapsedtime,
-             (double)opt.datasize / elapsedtime,
-             (double)opt.totio / elapsedtime); fflush(stdout);
-    }
-	
-	result = io_destroy(ctx);
-	errh_iogeneric("io_destroy", result );
-	close(fh);
-	for( i = 0; i< opt.threadcnt; i++)
-		free(listofiocb[i]);
-	free(iocbs);
-	free(listofiocb);
-	if(opt.debug){fprintf(stdout," sub_doio end "); fflush(stdout);}
-	
-}/* end of sub_doio */
+static const char * mopnames[MOP_N] = { "create", "write", "fsync", "rename", "stat", "unlink" };
 
+/* -z: a sequential write zone and its statistics in the phase */
+struct zone {
+	zone_t z;	/* z.wp: the next write, ahead of the device by the ios in flight */
+	int open;	/* a write cursor of the owner job is in it */
+	long inflight;
+	unsigned long long ios;
+	unsigned long long bytes;
+	unsigned long long latns;	/* sum, for the mean */
+	unsigned long long firstns;	/* submit of the first io */
+	unsigned long long lastns;	/* completion of the last io */
+};
 
-void puthelp(void)
+/* per target or per blocksize class statistics of a job */
+struct substat {
+	lathist_t lat;
+	unsigned long long ios;
+	unsigned long long bytes;
+};
+
+/*
+ * one test phase: the reads and writes are mixed by readpct, and both
+ * direction can be sequential or random
+ */
+struct phase {
+	const char * type;
+	int readpct;	/* 100: read only, 0: write only */
+	int rndread;
+	int rndwrite;
+	int replay;	/* the ios come from opt.tracefile */
+	int meta;	/* metadata workload (-f), not block io */
+	int precond;	/* -W: plain writes over the whole target, uniform random, no extras */
+};
+
+/* the aggregate of one sub_doio() run, for the sweep */
+struct runsum {
+	long long threadcnt;
+	double elapsed;
+	unsigned long long ios;
+	unsigned long long bytes;
+	double meanns;
+	double pctns;	/* the opt.kneepct percentile */
+};
+
+/* the common aggregate of the jobs of a phase (sub_doio, sub_meta) */
+struct jobsum {
+	unsigned long long beginns, endns;
+	unsigned long long ios, bytes;
+	unsigned long long cpuns, minflt, majflt;
+	unsigned long long sysc[2], batches[2];
+	unsigned long long perfval[PERFCNT_MAX];
+	int perfvalid[PERFCNT_MAX];
+	int perfuser;
+	struct rusage ru0, ru1;
+	lathist_t * lat;	/* allocated by the caller */
+};
+
+struct iojob {
+	int id;
+	int cpu;	/* pin to, -1: no pinning */
+	int ranoncpu;	/* where it really ran */
+	int ranonnode;
+	pthread_t tid;
+	char * * buff;	/* each job has own buff, kept between the phases */
+	const struct phase * phase;
+	int * fhs;	/* one per target */
+	long qd;
+	unsigned long long totio;	/* ios of this job */
+	unsigned long long runtimens;	/* of this run, 0: totio ios */
+	unsigned long long nextoffset[2]; /* seq tests: cursor of the reads and the writes */
+	unsigned long long seqstart;	/* seq tests: slice of the file, */
+	unsigned long long seqend;	/* time based runs wrap around in it */
+	unsigned long long firstblock;	/* random tests: slice of the file */
+	unsigned long long nblocks;	/* random tests: of job->align size */
+	int dist;		/* DIST_*: opt.dist, uniform in the preconditioning */
+	struct zipf zipf;
+	struct rng rng;
+	double gapns;		/* open loop: mean time between two ios */
+	struct ioslot * slots;
+	struct ioslot ** subq;	/* prepared, waiting for submit */
+	struct ioslot ** done;	/* filled by the reap */
+	io_context_t ctx;	/* aio engine */
+	struct iocb ** iocbs;
+	struct io_event * events;
+	struct aio_ring * aioring;	/* poll: the completion ring, NULL: io_getevents() */
+	uring_t ring;		/* uring engine */
+	char ** maps;		/* mmap engine: one per target */
+	unsigned long long * maplens;
+	lathist_t * lat;
+	unsigned long long doneios;	/* read by the interval reporter too */
+	unsigned long long donebytes;
+	int mixed;		/* per direction statistics too */
+	lathist_t * dirlat[2];
+	unsigned long long dirios[2];
+	unsigned long long dirbytes[2];
+	int finished;
+	struct substat * tgt;	/* more targets only */
+	struct substat * bss;	/* bssplit only */
+	unsigned long long align;	/* random offsets: opt.align or opt.mbl */
+	char * buffdirty;	/* pattern generator: a read overwrote the zero tail */
+	trace_t trace;		/* replay: own reader */
+	trace_rec_t rec;	/* replay: the next record of the job */
+	int recvalid;
+	unsigned long long tracegapns; /* replay: from the previous record to rec */
+	lathist_t * origlat;	/* replay: latencies of the trace */
+	unsigned long long verblocks;	/* verify: checked 4 KiB blocks */
+	unsigned long long badblocks;
+	int extras;		/* flushes and discards in this run */
+	unsigned long long sinceflush;	/* writes since the last flush */
+	unsigned long long bytessinceflush;
+	unsigned long long sincediscard;	/* ios since the last discard */
+	long nflush;		/* the flushes go round the targets */
+	struct substat opstat[2];	/* the flushes and the discards (OP_* - OP_FLUSH) */
+	struct ioslot ** syncq;	/* done synchronously in submit(), for the next reap */
+	long nsync;
+	unsigned long long beginns;
+	unsigned long long endns;
+	unsigned long long cpuns;	/* cpu time of the job between beginns and endns */
+	long minflt;		/* page faults of the job between beginns and endns */
+	long majflt;
+	perfcnt_t perf;		/* -H: counters of the job between beginns and endns */
+	struct stream * streams;	/* -N only */
+	struct substat * strst;	/* -N: per stream statistics */
+	int nextstream;		/* the streams take turns */
+	int iolog;		/* -L, not in the preconditioning */
+	unsigned long long iologged;	/* records into the ring */
+	unsigned long long iologdropped;	/* the ring was full */
+	struct mfile * mf;	/* -f: the existing files of the job */
+	unsigned long long nmf;
+	unsigned long long mfcap;	/* allocated */
+	unsigned long long mfseq;	/* the next file name */
+	struct substat * mopst;	/* -f: per op statistics (MOP_*) */
+	long * zcur;		/* -z: the open zones (index in opt.zones, -1: none) */
+	int nzcur;		/* slot i writes into zcur[i % nzcur] */
+	long znext;		/* the next zone of the job to open */
+	unsigned long long zresets;
+	unsigned long long sysc[2];	/* syscalls of the submits and of the reaps */
+	unsigned long long batches[2];	/* submit() calls, reap() calls with completions */
+};
+
+struct ioengine {
+	const char * name;
+	void (*setup)(struct iojob * job);
+	long (*submit)(struct iojob * job, struct ioslot ** list, long n);
+	/* timeout NULL: wait for min; reap NULL: the ios are done in submit() (ENG_SYNC) */
+	long (*reap)(struct iojob * job, long min, long max, struct ioslot ** done,
+		struct timespec * timeout);
+	void (*cleanup)(struct iojob * job);	/* NULL: nothing to undo */
+	int flags;	/* ENG_* */
+};
+
+/* engine flags */
+#define ENG_SYNC 1	/* the ios are done in submit(), depth 1 */
+#define ENG_MAP 2	/* the targets are mapped, opened for read and write */
+
+/*
+ * the discard has no async form in aio (and for the block devices in 
+ * io_uring), it is done in submit(), the slot is given back by the next reap
+ */
+static long do_discard(struct iojob * job, struct ioslot * slot)
 {
-	fprintf(stderr,"fillone version %s copyright by Maulis Adam 2024, using AGPL v3 or newer\n\n", VERS); 
-	fprintf(stderr,"Usage: fillone [options] filename blocksize datasize\n");
-	fprintf(stderr,"   -l lazy: datasize will be rounded up of multiple of blocksize\n");
-	fprintf(stderr,"   -p1 sequential write (overwrites data, extends file to datasize) (default test phase)\n");
-	fprintf(stderr,"   -p2 random write (overwrites data, does not extend file)\n");
-	fprintf(stderr,"   -p3 sequential read\n");
-	fprintf(stderr,"   -p4 random read\n");
-	fprintf(stderr,"   -r raw: uses O_DIRECT for open (disables local cache)\n");
-	fprintf(stderr,"   -u uncompressable and non-deduplicable pattern (the default is the 0xDEADBEEF pattern)\n");
-	fprintf(stderr,"   -t# thread count (# means integer)\n\n");
-	fprintf(stderr,"Environment variables:\n");
-    fprintf(stderr,"    DEBUG  # if not set, there is no debug messages\n"); 
-    fprintf(stderr,"    RANDOMPOOL # if not set use %s\n", RANDOMPOOL);
+	uint64_t range[2];
+	int fd = job->fhs[slot->target];
+
+	if( opt.tgtblk[slot->target] ){
+		range[0] = slot->devoffset;
+		range[1] = slot->len;
+		return ioctl(fd, BLKDISCARD, range) ? -errno : 0;
+	}
+	return fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, 
+		slot->devoffset, slot->len) ? -errno : 0;
 }
 
-int main(int argc, char* argv[])
+static inline void sync_discard(struct iojob * job, struct ioslot * slot)
 {
-	char * totbuff; /* allocated by malloc for 'opt.buff' */
-	int optarg;
-	int lazy = 0;
-	int isseqwrite=1, isrndwrite=1, isseqread=1,isrndread=1;
-	long long i;
-	unsigned long long j;
-	ssize_t status;
-	struct timeval starttime;
-	
-	opt.threadcnt = 1;
-	opt.rawmode = 0;
-	opt.uncompressable = FALSE;
+	slot->res = do_discard(job, slot);
+	job->sysc[0]++;
+	job->syncq[job->nsync++] = slot;
+}
 
-	if( NULL != getenv("DEBUG") ){
-		opt.debug = atoi(getenv("DEBUG"));
-		if( 0 == opt.debug ) opt.debug = 1;
-        printf("Debug messages are enabled.\n");fflush(stdout);
-	} else {
-		opt.debug = 0;
+/* the synchronously done slots into done[], returns their number */
+static inline long reap_sync(struct iojob * job, long max, struct ioslot ** done)
+{
+	long n;
+
+	for( n = 0; n < max && job->nsync; n++ ){
+		done[n] = job->syncq[--job->nsync];
+		errh_ioerr(done[n]->res, done[n]->res < 0 ? done[n]->res : 0, slot_opname(done[n]));
 	}
+	return n;
+}
 
-    if( NULL != getenv("RANDOMPOOL") ){
-        opt.randompool = getenv("RANDOMPOOL");
-    }else{
-        opt.randompool = RANDOMPOOL;
-    }
-    if(opt.debug){printf(" randompool=%s\n", opt.randompool);fflush(stdout);}
+/*
+ * aio engine (libaio)
+ * 	opt.poll: the completion ring of the context is mapped in userspace 
+ * 	(at the address of the context), it is polled there without syscall
+ */
+struct aio_ring { /* fs/aio.c */
+	unsigned id;
+	unsigned nr;	/* number of the io_events */
+	unsigned head;
+	unsigned tail;
+	unsigned magic;
+	unsigned compat_features;
+	unsigned incompat_features;
+	unsigned header_length;	/* size of aio_ring */
+	struct io_event io_events[0];
+};
+#define AIO_RING_MAGIC 0xa10a10a1
 
-	for(optarg=1;  optarg < argc && argv[optarg][0] == '-'; optarg++ ){
-		if(opt.debug){printf(" processing opt%d:%s\n",optarg,argv[optarg]);fflush(stdout);}
-		switch( argv[optarg][1] ){
-			case 'l': lazy = 1;
-				break;
-			case 'r': opt.rawmode = O_DIRECT;
-				break;
-			case 'u': opt.uncompressable = 1;
-				break;
-			case 'p': if( NULL == strchr(argv[optarg], '1')) isseqwrite = 0;
-				  if( NULL == strchr(argv[optarg], '2')) isrndwrite = 0;
-				  if( NULL == strchr(argv[optarg], '3')) isseqread = 0;
-				  if( NULL == strchr(argv[optarg], '4')) isrndread = 0;
-				break;
-			case 't':opt.threadcnt = atoi(argv[optarg]+2);
-				break;
-			default: fprintf(stderr,"Unknown opt: %s\n", argv[optarg]); 
-				puthelp();
-				return 1;
-				break;
+/* like io_getevents(), but spinning on the userspace ring */
+static long aio_spin(struct iojob * job, long min, long max, struct timespec * timeout)
+{
+	struct aio_ring * ring = job->aioring;
+	unsigned head, tail;
+	unsigned long long deadline = 0;
+	long n = 0;
+
+	if( NULL != timeout )
+		deadline = now_ns() + timeout->tv_sec * 1000000000ULL + timeout->tv_nsec;
+	for(;;){
+		head = ring->head;
+		tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+		while( head != tail && n < max ){
+			job->events[n++] = ring->io_events[head];
+			if( ++head == ring->nr ) head = 0;
 		}
-	}/*end for optarg */
+		__atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+		if( n >= min || ( NULL != timeout && now_ns() >= deadline ) )
+			return n;
+		__builtin_ia32_pause();
+	}
+}
 
-	if( argc < optarg + 3){
-		fprintf(stderr,"Insufficient number of parameters.\n");
-		puthelp();
-		return 1;
+void eng_aio_setup(struct iojob * job)
+{
+	long result;
+
+	memset( &job->ctx, 0, sizeof(job->ctx));
+	result = io_queue_init(job->qd, &job->ctx);
+	errh_iogeneric("io_queue_init", result );
+	job->aioring = NULL;
+	if( opt.poll ){
+		job->aioring = (struct aio_ring *)job->ctx;
+		if( AIO_RING_MAGIC != job->aioring->magic || job->aioring->incompat_features ){
+			fprintf(stderr, "Warn: unknown aio ring format, job %d waits in io_getevents()\n", job->id);
+			job->aioring = NULL;
+		}
 	}
-	
-	if(1>opt.threadcnt){
-		fprintf(stderr,"Threadcount (-t) must be at least 1\n");
-		return 1;
+	job->iocbs = (struct iocb **) calloc(job->qd , sizeof(struct iocb *));
+	errh_malloc(job->iocbs, "array of struct iocb");
+	job->events = calloc(job->qd , sizeof( struct io_event));
+	errh_malloc(job->events, "array of struct io_events");
+}
+
+long eng_aio_submit(struct iojob * job, struct ioslot ** list, long n)
+{
+	long i, result, submitted, naio;
+
+	for(i = naio = 0; i < n; i++){
+		if( OP_DISCARD == list[i]->op ){
+			sync_discard(job, list[i]);
+			continue;
+		}
+		if( OP_FLUSH == list[i]->op ){
+			if( opt.flushfull )
+				io_prep_fsync(&list[i]->iocb, job->fhs[list[i]->target]);
+			else
+				io_prep_fdsync(&list[i]->iocb, job->fhs[list[i]->target]);
+		}else if(list[i]->isread)
+			io_prep_pread(&list[i]->iocb, job->fhs[list[i]->target], list[i]->buf, 
+				list[i]->len, list[i]->devoffset);
+		else
+			io_prep_pwrite(&list[i]->iocb, job->fhs[list[i]->target], list[i]->buf, 
+				list[i]->len, list[i]->devoffset);
+		list[i]->iocb.data = list[i]; /* io_prep_* clears it */
+		job->iocbs[naio++] = &list[i]->iocb;
 	}
-	
-	opt.fname = strdup(argv[optarg]);
-	if(opt.debug){printf(" filename=%s\n",opt.fname);fflush(stdout);}
-	optarg++;
-	
-	opt.mbl = atol( argv[optarg] );
-	if( 0 >= opt.mbl){
-		fprintf(stderr," Invalid blocksize (%s)\n",argv[optarg]);
-		return 1;
+	for(submitted = 0; submitted < naio; submitted += result){
+		result = io_submit( job->ctx, naio - submitted, job->iocbs + submitted);
+		job->sysc[0]++;
+		errh_io_submit(result);
 	}
-	if(opt.debug){printf(" blocksize=%lld\n",opt.mbl);fflush(stdout);}
-	optarg++;
+	return n;
+}
 
-	opt.datasize = atoint64(argv[optarg]);
-	if( opt.datasize <= 0 ){
-		fprintf(stderr," Invalid datasize (%lld != %s)\n",
-				opt.datasize, argv[optarg]);
-		return 1;
+long eng_aio_reap(struct iojob * job, long min, long max, struct ioslot ** done,
+		struct timespec * timeout)
+{
+	long i, n, result;
+	struct timespec nowait = { 0, 0 };
+
+	n = reap_sync(job, max, done);
+	if( n >= max ) return n;
+	if( n >= min ){ /* only what is already there */
+		min = 0;
+		timeout = &nowait;
+	}else{
+		min -= n;
 	}
-	if(opt.debug){printf(" datasize=%lld\n",opt.datasize);fflush(stdout);}
-	
-	if( opt.datasize % opt.mbl != 0 ){
-		if(lazy){
-			if(opt.debug)printf(" datasize was rounded up:%lld ->",
-					opt.datasize);
-			opt.datasize = (opt.datasize/opt.mbl +1LL) * opt.mbl;
-			if(opt.debug){printf("%lld\n", opt.datasize); fflush(stdout);}
-		}else{
-			fprintf(stderr,"Err: datasize is not multiple of blocksize\n");
-			return 1;
-		}
+	if( NULL != job->aioring )
+		result = aio_spin(job, min, max - n, timeout);
+	else{
+		result = io_getevents( job->ctx, min, max - n, job->events, timeout);
+		job->sysc[1]++;
 	}
-	opt.totio = opt.datasize/opt.mbl;
-	if(opt.debug){printf(" total ios=%lld\n",opt.totio);fflush(stdout);}
-	if( opt.threadcnt > opt.totio){
-		opt.threadcnt = opt.totio;
-		fprintf(stderr,
-			"Warn: to small datasize, threadcount shrink down to %lld\n", 
-			opt.threadcnt);
+	errh_io_getevents(result);
+	for(i = 0; i < result; i++, n++){
+		done[n] = (struct ioslot *)job->events[i].data;
+		done[n]->res = (long)job->events[i].res;
+		errh_ioerr(done[n]->res, 
+			done[n]->res < 0 ? done[n]->res : (long)job->events[i].res2,
+			slot_opname(done[n]));
 	}
+	return n;
+}
 
-	opt.rndfh = open(opt.randompool, O_RDONLY);
-	if( opt.rndfh <0 ){
-		fprintf(stderr, "Error opening '%s'", opt.randompool);
+void eng_aio_cleanup(struct iojob * job)
+{
+	long result;
+
+	result = io_destroy(job->ctx);
+	errh_iogeneric("io_destroy", result );
+	free(job->iocbs);
+	free(job->events);
+}
+
+/*
+ * uring engine (io_uring, see uring.h)
+ * 	opt.regbuf: the slot buffers are registered, READ_FIXED/WRITE_FIXED
+ * 	opt.regfile: the file handles are registered (index: the target)
+ * 	opt.sqpoll: a kernel thread polls the submission ring, no syscall to submit
+ * 	opt.iopoll: the block layer is polled for the completions (by the reap, 
+ * 	in the kernel), no interrupts; needs O_DIRECT
+ * 	opt.poll: the reap spins on the completion ring instead of sleeping
+ */
+void eng_uring_setup(struct iojob * job)
+{
+	long result;
+	long i;
+	struct iovec * iov;
+
+	result = uring_init(&job->ring, job->qd, 
+		(opt.sqpoll ? IORING_SETUP_SQPOLL : 0) | (opt.iopoll ? IORING_SETUP_IOPOLL : 0));
+	errh_iogeneric("io_uring_setup", result );
+	if(opt.regbuf){
+		iov = (struct iovec *)calloc(job->qd, sizeof(struct iovec));
+		errh_malloc(iov, "array of struct iovec");
+		for(i = 0; i < job->qd; i++){
+			iov[i].iov_base = job->slots[i].buf;
+			iov[i].iov_len = roundup4k(opt.bufsize);
+		}
+		result = uring_register(&job->ring, IORING_REGISTER_BUFFERS, iov, job->qd);
+		errh_iogeneric("io_uring_register(buffers)", result );
+		free(iov);
+	}
+	if(opt.regfile){
+		result = uring_register(&job->ring, IORING_REGISTER_FILES, job->fhs, opt.ntargets);
+		errh_iogeneric("io_uring_register(files)", result );
+	}
+}
+
+long eng_uring_submit(struct iojob * job, struct ioslot ** list, long n)
+{
+	long i, result, nsqe = 0;
+	struct io_uring_sqe * sqe;
+	unsigned long long enters = job->ring.enters;
+
+	for(i = 0; i < n; i++){
+		if( OP_DISCARD == list[i]->op && opt.tgtblk[list[i]->target] ){
+			sync_discard(job, list[i]);
+			continue;
+		}
+		sqe = uring_get_sqe(&job->ring);
+		if( NULL == sqe ){
+			fprintf(stderr, "Error: submission ring is full (internal failure)\n");
+			exit(1);
+		}
+		if( OP_FLUSH == list[i]->op ){
+			sqe->opcode = IORING_OP_FSYNC;
+			sqe->fsync_flags = opt.flushfull ? 0 : IORING_FSYNC_DATASYNC;
+		}else if( OP_DISCARD == list[i]->op ){
+			sqe->opcode = IORING_OP_FALLOCATE;
+		}else if(opt.regbuf){
+			sqe->opcode = list[i]->isread ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+			sqe->buf_index = list[i]->idx;
+		}else{
+			sqe->opcode = list[i]->isread ? IORING_OP_READ : IORING_OP_WRITE;
+		}
+		if(opt.regfile){
+			sqe->fd = list[i]->target; /* index in the registered files */
+			sqe->flags = IOSQE_FIXED_FILE;
+		}else{
+			sqe->fd = job->fhs[list[i]->target];
+		}
+		if( OP_DISCARD == list[i]->op ){ /* fallocate: the length in addr, the mode in len */
+			sqe->addr = list[i]->len;
+			sqe->len = FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE;
+			sqe->off = list[i]->devoffset;
+		}else if( OP_RW == list[i]->op ){ /* the flush is for the whole file */
+			sqe->addr = (unsigned long)list[i]->buf;
+			sqe->len = list[i]->len;
+			sqe->off = list[i]->devoffset;
+		}
+		sqe->user_data = (unsigned long)list[i];
+		nsqe++;
+	}
+	if( nsqe ){
+		result = uring_submit(&job->ring, 0);
+		errh_io_submit(result);
+	}
+	job->sysc[0] += job->ring.enters - enters; /* none with sqpoll */
+	return n;
+}
+
+long eng_uring_reap(struct iojob * job, long min, long max, struct ioslot ** done,
+		struct timespec * timeout)
+{
+	long n, result;
+	struct io_uring_cqe * cqe;
+	unsigned long long deadline = 0;
+	unsigned long long enters = job->ring.enters;
+
+	if( opt.poll && NULL != timeout )
+		deadline = now_ns() + timeout->tv_sec * 1000000000ULL + timeout->tv_nsec;
+	for(n = reap_sync(job, max, done); n < max; ){
+		cqe = uring_peek_cqe(&job->ring);
+		if( NULL == cqe ){
+			if( n >= min ) break;
+			if( opt.poll ){ /* spin, iopoll: one pass of the kernel over the device queues */
+				if( NULL != timeout && now_ns() >= deadline ) break;
+				if( opt.iopoll && ! opt.sqpoll ){
+					result = uring_wait(&job->ring, 0);
+					if( -EINTR != result && -EAGAIN != result ) errh_io_getevents(result);
+				}else{
+					__builtin_ia32_pause();
+				}
+				continue;
+			}
+			if( NULL == timeout )
+				result = uring_wait(&job->ring, min - n);
+			else
+				result = uring_wait_timeout(&job->ring, min - n, timeout);
+			if( -EINTR == result ) continue;
+			if( -ETIME == result ) break;
+			errh_io_getevents(result);
+			continue;
+		}
+		done[n] = (struct ioslot *)cqe->user_data;
+		done[n]->res = cqe->res;
+		uring_cqe_seen(&job->ring);
+		errh_ioerr(done[n]->res, done[n]->res < 0 ? done[n]->res : 0, 
+			slot_opname(done[n]));
+		n++;
+	}
+	job->sysc[1] += job->ring.enters - enters;
+	return n;
+}
+
+void eng_uring_cleanup(struct iojob * job)
+{
+	uring_exit(&job->ring);
+}
+
+/*
+ * synchronous engines: the ios are done in submit(), one by one, and given
+ * back by the next reap (like the discards, no reap() of the engine), so 
+ * the depth of a job is 1, the parallelism comes from the jobs (-j). The 
+ * page cache is in the path.
+ */
+
+/* fdatasync() or fsync() of the target */
+static inline long sync_flush(struct iojob * job, struct ioslot * slot)
+{
+	int fd = job->fhs[slot->target];
+
+	return ( opt.flushfull ? fsync(fd) : fdatasync(fd) ) ? -errno : 0;
+}
+
+/*
+ * mmap engine
+ * 	every job maps the targets (shared), a read copies from the mapping
+ * 	into the slot buffer, a write the other way, so the pages are touched
+ * 	by the cpu and the page faults do the io. The files are extended to 
+ * 	the datasize for the writes.
+ * 	opt.populate: MAP_POPULATE, the faults happen in the setup
+ * 	opt.madvice: madvise() of the whole mapping, -1: none
+ * 	the flush is msync() (and fsync() with -F...,fsync)
+ */
+void eng_mmap_setup(struct iojob * job)
+{
+	unsigned long long need;
+	struct stat st;
+	int t, prot;
+
+	job->maps = (char **)calloc(opt.ntargets, sizeof(char *));
+	errh_malloc(job->maps, "array of mappings");
+	job->maplens = (unsigned long long *)calloc(opt.ntargets, sizeof(unsigned long long));
+	errh_malloc(job->maplens, "array of mapping sizes");
+	prot = PROT_READ | ( 100 > job->phase->readpct ? PROT_WRITE : 0 );
+	need = 1 == opt.ntargets || opt.targetrnd ? opt.datasize : 
+		( opt.datasize / opt.mbl / opt.ntargets + 1 ) * opt.mbl; /* striped */
+	for( t = 0; t < opt.ntargets; t++ ){
+		job->maplens[t] = getfilesize(opt.fnames[t]);
+		if( ( PROT_WRITE & prot ) && ! opt.tgtblk[t] && job->maplens[t] < need ){
+			if( 0 > ftruncate(job->fhs[t], need) || 0 > fstat(job->fhs[t], &st) ){
+				fprintf(stderr, "Error: cannot extend '%s'", opt.fnames[t]);
+				perror(" ");
+				exit(1);
+			}
+			job->maplens[t] = st.st_size;
+		}
+		if( 0 == job->maplens[t] ){
+			fprintf(stderr, "Error: '%s' is empty, nothing to map\n", opt.fnames[t]);
+			exit(1);
+		}
+		job->maps[t] = (char *)mmap(NULL, job->maplens[t], prot, 
+			MAP_SHARED | ( opt.populate ? MAP_POPULATE : 0 ), job->fhs[t], 0);
+		if( MAP_FAILED == job->maps[t] ){
+			fprintf(stderr, "Error: cannot map '%s'", opt.fnames[t]);
+			perror(" ");
+			exit(1);
+		}
+		if( 0 <= opt.madvice && madvise(job->maps[t], job->maplens[t], opt.madvice) )
+			perror("Warn: madvise");
+	}
+}
+
+long eng_mmap_submit(struct iojob * job, struct ioslot ** list, long n)
+{
+	struct ioslot * slot;
+	char * p;
+	long i;
+
+	for( i = 0; i < n; i++ ){
+		slot = list[i];
+		if( OP_DISCARD == slot->op ){
+			sync_discard(job, slot);
+			continue;
+		}
+		if( OP_FLUSH == slot->op ){
+			slot->res = msync(job->maps[slot->target], job->maplens[slot->target], MS_SYNC) ? -errno : 
+				( opt.flushfull ? sync_flush(job, slot) : 0 );
+			job->sysc[0] += opt.flushfull ? 2 : 1;
+		}else if( slot->devoffset + slot->len > job->maplens[slot->target] ){
+			slot->res = -ENXIO; /* out of the mapping: no SIGBUS */
+		}else{
+			p = job->maps[slot->target] + slot->devoffset;
+			if( slot->isread )
+				memcpy(slot->buf, p, slot->len);
+			else
+				memcpy(p, slot->buf, slot->len);
+			slot->res = slot->len;
+		}
+		job->syncq[job->nsync++] = slot;
+	}
+	return n;
+}
+
+void eng_mmap_cleanup(struct iojob * job)
+{
+	int t;
+
+	for( t = 0; t < opt.ntargets; t++ )
+		munmap(job->maps[t], job->maplens[t]);
+	free(job->maps);
+	free(job->maplens);
+}
+
+/*
+ * psync engine: pread() and pwrite()
+ * 	opt.fadvice: posix_fadvise() of the whole targets in the setup, -1: none
+ * 	opt.dropbehind: POSIX_FADV_DONTNEED of every io after it is done
+ * 	opt.readahead: readahead() of this many bytes after every read, 0: off
+ */
+void eng_psync_setup(struct iojob * job)
+{
+	int t;
+
+	for( t = 0; 0 <= opt.fadvice && t < opt.ntargets; t++ )
+		if( posix_fadvise(job->fhs[t], 0, 0, opt.fadvice) )
+			fprintf(stderr, "Warn: posix_fadvise() of '%s' failed\n", opt.fnames[t]);
+}
+
+long eng_psync_submit(struct iojob * job, struct ioslot ** list, long n)
+{
+	struct ioslot * slot;
+	ssize_t res;
+	int fd;
+	long i;
+
+	for( i = 0; i < n; i++ ){
+		slot = list[i];
+		if( OP_DISCARD == slot->op ){
+			sync_discard(job, slot);
+			continue;
+		}
+		fd = job->fhs[slot->target];
+		job->sysc[0]++;
+		if( OP_FLUSH == slot->op ){
+			slot->res = sync_flush(job, slot);
+		}else{
+			if( slot->isread )
+				res = pread(fd, slot->buf, slot->len, slot->devoffset);
+			else
+				res = pwrite(fd, slot->buf, slot->len, slot->devoffset);
+			slot->res = 0 > res ? -errno : res;
+			if( slot->isread && opt.readahead ){
+				readahead(fd, slot->devoffset + slot->len, opt.readahead);
+				job->sysc[0]++;
+			}
+			if( opt.dropbehind ){
+				posix_fadvise(fd, slot->devoffset, slot->len, POSIX_FADV_DONTNEED);
+				job->sysc[0]++;
+			}
+		}
+		job->syncq[job->nsync++] = slot;
+	}
+	return n;
+}
+
+static const struct ioengine engines[] = {
+	{ "aio", eng_aio_setup, eng_aio_submit, eng_aio_reap, eng_aio_cleanup, 0 },
+	{ "uring", eng_uring_setup, eng_uring_submit, eng_uring_reap, eng_uring_cleanup, 0 },
+	{ "mmap", eng_mmap_setup, eng_mmap_submit, NULL, eng_mmap_cleanup, ENG_SYNC | ENG_MAP },
+	{ "psync", eng_psync_setup, eng_psync_submit, NULL, NULL, ENG_SYNC },
+	{ NULL, NULL, NULL, NULL, NULL, 0 }
+};
+
+/* the completions from the engine, or the synchronously done ios */
+static inline long engine_reap(struct iojob * job, long min, long max, struct ioslot ** done,
+		struct timespec * timeout)
+{
+	if( NULL == opt.engine->reap )
+		return reap_sync(job, max, done);
+	return opt.engine->reap(job, min, max, done, timeout);
+}
+
+/*
+ * size with k/m/g suffix, *end is set like strtoull()
+ */
+unsigned long long parse_size(const char * arg, char ** end)
+{
+	unsigned long long v;
+
+	v = strtoull(arg, end, 10);
+	if( *end == arg ) return 0;
+	switch( **end ){
+		case 'k': case 'K': v <<= 10; (*end)++; break;
+		case 'm': case 'M': v <<= 20; (*end)++; break;
+		case 'g': case 'G': v <<= 30; (*end)++; break;
+	}
+	return v;
+}
+
+/*
+ * -e<engine>[,flag...]  returns FALSE if the engine is unknown
+ */
+int parse_engine(const char * arg)
+{
+	int i;
+	size_t len;
+	const char * ca;
+	char * end;
+
+	len = strcspn(arg, ",");
+	for( i = 0; NULL != engines[i].name; i++ ){
+		if( len == strlen(engines[i].name) && 0 == strncmp(arg, engines[i].name, len) ){
+			opt.engine = &engines[i];
+			opt.regbuf = NULL != strstr(arg, ",regbuf");
+			opt.regfile = NULL != strstr(arg, ",regfile");
+			opt.sqpoll = NULL != strstr(arg, ",sqpoll");
+			opt.iopoll = NULL != strstr(arg, ",iopoll");
+			if( opt.iopoll ) /* nothing else would poll the device */
+				opt.poll = TRUE;
+			opt.populate = NULL != strstr(arg, ",populate");
+			opt.dropbehind = NULL != strstr(arg, ",dontneed");
+			opt.madvice = opt.fadvice = -1;
+			if( NULL != strstr(arg, ",seq") ){
+				opt.madvice = MADV_SEQUENTIAL;
+				opt.fadvice = POSIX_FADV_SEQUENTIAL;
+			}else if( NULL != strstr(arg, ",rnd") ){
+				opt.madvice = MADV_RANDOM;
+				opt.fadvice = POSIX_FADV_RANDOM;
+			}else if( NULL != strstr(arg, ",willneed") ){
+				opt.madvice = MADV_WILLNEED;
+				opt.fadvice = POSIX_FADV_WILLNEED;
+			}else if( NULL != strstr(arg, ",noreuse") ){
+				opt.fadvice = POSIX_FADV_NOREUSE;
+			}
+			opt.readahead = 0;
+			if( NULL != ( ca = strstr(arg, ",ra=") ) ){
+				opt.readahead = parse_size(ca + 4, &end);
+				if( 0 == opt.readahead || ( '\0' != *end && ',' != *end ) ) return FALSE;
+			}
+			/* the hints of the synchronous engines only */
+			if( ( 0 <= opt.fadvice || opt.dropbehind || opt.readahead ) && 
+			    ! ( ENG_SYNC & engines[i].flags ) )
+				return FALSE;
+			if( opt.populate && ! ( ENG_MAP & engines[i].flags ) )
+				return FALSE;
+			if( ( opt.dropbehind || opt.readahead || ( 0 <= opt.fadvice && 0 > opt.madvice ) ) && 
+			    ( ENG_MAP & engines[i].flags ) ) /* psync only */
+				return FALSE;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/*
+ * -q[submit=#][,complete=#][,low=#]
+ */
+int parse_batch(const char * arg)
+{
+	long * val;
+	char * end;
+
+	opt.batching = TRUE;
+	while( '\0' != *arg ){
+		if( 0 == strncmp(arg, "submit=", 7) ){
+			val = &opt.batchsub;
+			arg += 7;
+		}else if( 0 == strncmp(arg, "complete=", 9) ){
+			val = &opt.batchcomp;
+			arg += 9;
+		}else if( 0 == strncmp(arg, "low=", 4) ){
+			val = &opt.iolow;
+			arg += 4;
+		}else{
+			return FALSE;
+		}
+		*val = strtol(arg, &end, 10);
+		if( end == arg || 0 > *val || ( val == &opt.batchcomp && 0 == *val ) || ( ',' != *end && '\0' != *end ) )
+			return FALSE;
+		arg = end;
+		if( ',' == *arg ) arg++;
+	}
+	return TRUE;
+}
+
+/*
+ * -d<dist>  returns FALSE if it is invalid
+ * 	uniform | zipf[:theta] | hot:x:y (x% of the ios to the first y% of the device)
+ */
+int parse_dist(const char * arg)
+{
+	char * end;
+
+	if( 0 == strcmp(arg, "uniform") ){
+		opt.dist = DIST_UNIFORM;
+		return TRUE;
+	}
+	if( 0 == strncmp(arg, "zipf", 4) ){
+		opt.dist = DIST_ZIPF;
+		opt.zipftheta = 0.99;
+		if( ':' == arg[4] )
+			opt.zipftheta = strtod(arg + 5, &end);
+		else if( '\0' != arg[4] )
+			return FALSE;
+		return opt.zipftheta > 0.0 && opt.zipftheta != 1.0;
+	}
+	if( 0 == strncmp(arg, "hot:", 4) ){
+		opt.dist = DIST_HOT;
+		opt.hotio = strtod(arg + 4, &end) / 100.0;
+		if( ':' != *end ) return FALSE;
+		opt.hotarea = strtod(end + 1, &end) / 100.0;
+		return opt.hotio > 0.0 && opt.hotio <= 1.0 &&
+			opt.hotarea > 0.0 && opt.hotarea < 1.0;
+	}
+	return FALSE;
+}
+
+/* block number of the next random io */
+static inline unsigned long long rnd_block(struct iojob * job)
+{
+	unsigned long long hot;
+
+	switch( job->dist ){
+		case DIST_ZIPF:
+			return zipf_next(&job->zipf, &job->rng);
+		case DIST_HOT:
+			hot = (unsigned long long)(opt.hotarea * (double)job->nblocks);
+			if( 0 == hot ) hot = 1;
+			if( rng_double(&job->rng) < opt.hotio || hot >= job->nblocks )
+				return rng_below(&job->rng, hot);
+			return hot + rng_below(&job->rng, job->nblocks - hot);
+		default:
+			return rng_below(&job->rng, job->nblocks);
+	}
+}
+
+/*
+ * replay_fetch
+ * 	the next record of the job (every opt.njobs-th of the trace) into 
+ * 	job->rec, and its distance from the previous one on the timeline
+ */
+void replay_fetch(struct iojob * job)
+{
+	unsigned long long prevns;
+	long skip;
+	int status;
+
+	prevns = job->recvalid ? job->rec.ns : opt.tracestart;
+	skip = job->recvalid ? opt.njobs : job->id + 1;
+	while( skip > 0 ){
+		status = trace_next(&job->trace, &job->rec);
+		if( 0 > status ){
+			fprintf(stderr, "Error: invalid trace record in '%s' (line %lu)\n", 
+				opt.tracefile, job->trace.line);
+			exit(1);
+		}
+		if( 0 == status ){ /* end of the trace: only the time based runs get here */
+			trace_rewind(&job->trace);
+			skip = job->id + 1;
+			prevns = ~0ULL;
+			continue;
+		}
+		skip--;
+	}
+	job->recvalid = TRUE;
+	job->tracegapns = job->rec.ns > prevns ? 
+		(unsigned long long)((double)(job->rec.ns - prevns) / opt.replayspeed) : 0;
+	if( 0.0 == opt.replayspeed ) job->tracegapns = 0;
+}
+
+/*
+ * replay_next
+ * 	direction, offset and length of the slot from the trace, the offsets
+ * 	beyond the target are wrapped (aligned to opt.replayalign)
+ */
+void replay_next(struct iojob * job, struct ioslot * slot)
+{
+	slot->isread = TRACE_READ == job->rec.op;
+	slot->len = job->rec.len;
+	slot->offset = job->rec.offset;
+	if( slot->offset + slot->len > opt.filesize )
+		slot->offset = slot->offset % (opt.filesize - slot->len + 1) / opt.replayalign * opt.replayalign;
+	if( job->rec.latns )
+		lathist_record(job->origlat, job->rec.latns);
+	replay_fetch(job);
+}
+
+/* slot->offset to target and devoffset */
+static inline void map_target(struct iojob * job, struct ioslot * slot)
+{
+	if( 1 == opt.ntargets ){
+		slot->target = 0;
+		slot->devoffset = slot->offset;
+	}else if( opt.targetrnd ){
+		slot->target = (int)rng_below(&job->rng, opt.ntargets);
+		slot->devoffset = slot->offset;
+	}else{ /* striped, the stripe unit is the blocksize */
+		slot->target = (int)(slot->offset / opt.mbl % opt.ntargets);
+		slot->devoffset = slot->offset / opt.mbl / opt.ntargets * opt.mbl;
+	}
+}
+
+/*
+ * prep_extra
+ * 	a flush or a discard into the slot instead of the next io, if it is due.
+ * 	They come on top of the ios of the job: job->totio grows.
+ */
+static int prep_extra(struct iojob * job, struct ioslot * slot)
+{
+	unsigned long long start, end;
+
+	if( 100 <= job->phase->readpct ) 
+		return FALSE;
+	if( ( opt.flushn && job->sinceflush >= opt.flushn ) ||
+	    ( opt.flushbytes && job->bytessinceflush >= opt.flushbytes ) ){
+		job->sinceflush = job->bytessinceflush = 0;
+		slot->op = OP_FLUSH;
+		slot->isread = FALSE;
+		slot->target = job->nflush++ % opt.ntargets;
+		slot->offset = slot->devoffset = 0;
+		slot->len = 0;
+		job->totio++;
+		return TRUE;
+	}
+	if( opt.discardn && job->sincediscard >= opt.discardn ){
+		job->sincediscard = 0;
+		if( job->phase->replay ){
+			start = 0;
+			end = opt.filesize;
+		}else if( job->nblocks ){ /* random tests: the slice of the job */
+			start = job->align * job->firstblock;
+			end = job->align * (job->firstblock + job->nblocks);
+		}else{
+			start = job->seqstart;
+			end = job->seqend;
+		}
+		slot->op = OP_DISCARD;
+		slot->isread = FALSE;
+		slot->len = opt.discardlen ? opt.discardlen : opt.mbl;
+		if( slot->len > end - start ) slot->len = end - start;
+		slot->offset = start + rng_below(&job->rng, (end - start) / slot->len) * slot->len;
+		map_target(job, slot);
+		if( 1 < opt.ntargets && ! opt.targetrnd && slot->len > opt.mbl - slot->offset % opt.mbl )
+			slot->len = opt.mbl - slot->offset % opt.mbl; /* striped: in one stripe unit */
+		job->totio++;
+		return TRUE;
+	}
+	return FALSE;
+}
+
+/*
+ * -z: the next zone of the job for a write cursor, the zones of the job
+ * in order; a full one is reset (,reset) if no io of it is in flight
+ */
+static long zone_open(struct iojob * job)
+{
+	struct zone * z;
+	long tries, idx;
+	int status;
+
+	for( tries = 0; tries < 2 * ( opt.nzones / opt.njobs + 1 ); tries++ ){
+		if( job->znext >= opt.nzones ){
+			if( ! opt.zreset ) break;
+			job->znext = job->id; /* again from the first one */
+		}
+		idx = job->znext;
+		job->znext += opt.njobs;
+		z = &opt.zones[idx];
+		if( z->open ) continue;
+		if( z->z.wp >= z->z.start + z->z.cap ){
+			if( ! opt.zreset || z->inflight ) continue;
+			status = zoned_reset(job->fhs[0], &z->z);
+			if( status ){
+				fprintf(stderr, "Error: cannot reset zone %u: %s\n", z->z.no, strerror(-status));
+				exit(1);
+			}
+			job->zresets++;
+		}
+		z->open = TRUE;
+		return idx;
+	}
+	fprintf(stderr, "Error: job %d is out of free zones%s\n", job->id, 
+		opt.zreset ? "" : " (reset them: -z...,reset)");
+	exit(1);
+}
+
+/* -z: the write goes to the write pointer of an open zone of the job */
+static void zone_write(struct iojob * job, struct ioslot * slot)
+{
+	long * cur = &job->zcur[slot->idx % job->nzcur];
+	struct zone * z;
+
+	if( 0 > *cur || opt.zones[*cur].z.wp >= opt.zones[*cur].z.start + opt.zones[*cur].z.cap ){
+		if( 0 <= *cur ) opt.zones[*cur].open = FALSE;
+		*cur = zone_open(job);
+	}
+	z = &opt.zones[*cur];
+	if( slot->len > z->z.start + z->z.cap - z->z.wp ) /* the last write fills the zone */
+		slot->len = z->z.start + z->z.cap - z->z.wp;
+	slot->offset = z->z.wp;
+	z->z.wp += slot->len;
+	z->inflight++;
+	slot->zone = *cur;
+}
+
+/*
+ * prep_io
+ * 	next direction, offset (and pattern) into the slot
+ */
+void prep_io(struct iojob * job, struct ioslot * slot)
+{
+	unsigned long long ofs, w, end;
+	struct stream * st;
+	int dir;
+
+	slot->op = OP_RW;
+	slot->stream = -1;
+	slot->zone = -1;
+	if( job->extras && prep_extra(job, slot) )
+		return;
+	if( job->phase->replay ){
+		replay_next(job, slot);
+	}else{
+		if( 100 <= job->phase->readpct )
+			slot->isread = TRUE;
+		else if( 0 >= job->phase->readpct )
+			slot->isread = FALSE;
+		else
+			slot->isread = (int)rng_below(&job->rng, 100) < job->phase->readpct;
+		dir = slot->isread ? DIR_READ : DIR_WRITE;
+
+		slot->len = opt.mbl;
+		if( NULL != job->bss ){
+			w = rng_below(&job->rng, opt.bsscum[opt.nbss - 1]);
+			for( slot->bsclass = 0; w >= opt.bsscum[slot->bsclass]; slot->bsclass++ )
+				;
+			slot->len = opt.bss[slot->bsclass];
+		}
+		if( NULL != opt.zones && ! slot->isread ){
+			zone_write(job, slot);
+		}else if( slot->isread ? job->phase->rndread : job->phase->rndwrite ){
+			slot->offset = job->align * (job->firstblock + rnd_block(job));
+			end = job->align * (job->firstblock + job->nblocks);
+			if( slot->offset + slot->len > end ) /* bssplit, align: pushed back into the slice */
+				slot->offset = (end - slot->len) / job->align * job->align;
+		}else if( NULL != job->streams ){
+			slot->stream = job->nextstream;
+			job->nextstream = ( job->nextstream + 1 ) % opt.nstreams;
+			st = &job->streams[slot->stream];
+			if( st->next[dir] + slot->len > st->end )
+				st->next[dir] = st->begin;
+			slot->offset = st->next[dir];
+			st->next[dir] += slot->len;
+		}else{
+			if( job->nextoffset[dir] + slot->len > job->seqend ) /* only the time based runs and the mixed phase get here */
+				job->nextoffset[dir] = job->seqstart;
+			slot->offset = job->nextoffset[dir];
+			job->nextoffset[dir] += slot->len;
+		}
+	}
+	map_target(job, slot);
+	if( ! slot->isread ){
+		job->sinceflush++;
+		job->bytessinceflush += slot->len;
+	}
+	job->sincediscard++;
+	if( slot->isread ){
+		job->buffdirty[slot->idx] = TRUE;
+	}else if( opt.compress > 0.0 || opt.dedup > 0.0 ){
+		if( job->buffdirty[slot->idx] ){
+			memset(slot->buf, 0, opt.bufsize);
+			job->buffdirty[slot->idx] = FALSE;
+		}
+		for( ofs = 0; ofs < slot->len; ofs += PATTERN_BLOCK )
+			pattern_fill(&opt.pattern, slot->buf + ofs,
+				slot->len - ofs < PATTERN_BLOCK ? slot->len - ofs : PATTERN_BLOCK,
+				pattern_key(&opt.pattern, (slot->offset + ofs) >> 12));
+	}else if( ! slot->isread && opt.uncompressable ) {/* minden 4kiB hatarnal kellene offsetet beirni, 32 biten, ez 16TiB uniq */
+		for( ofs= 0 ; ofs<slot->len; ofs+=4096 )
+			*( (uint32_t *) (slot->buf+ofs) ) = (slot->offset + ofs) >> 12;
+	}
+}
+
+/*
+ * -c[cpulist]  "0,2,4-7", without list: the available cpus in order
+ * 	returns FALSE if it is invalid
+ */
+int parse_cpus(const char * arg)
+{
+	cpu_set_t set;
+	char * end;
+	long from, to, i;
+
+	opt.ncpus = 0;
+	opt.cpus = (int *)calloc(CPU_SETSIZE, sizeof(int));
+	errh_malloc(opt.cpus, "cpu list");
+	if( '\0' == *arg ){
+		if( 0 != sched_getaffinity(0, sizeof(set), &set) ){
+			perror("Err: sched_getaffinity said");
+			return FALSE;
+		}
+		for( i = 0; i < CPU_SETSIZE; i++ )
+			if( CPU_ISSET(i, &set) ) opt.cpus[opt.ncpus++] = i;
+		return 0 < opt.ncpus;
+	}
+	while( '\0' != *arg ){
+		from = to = strtol(arg, &end, 10);
+		if( end == arg ) return FALSE;
+		if( '-' == *end ){
+			arg = end + 1;
+			to = strtol(arg, &end, 10);
+			if( end == arg ) return FALSE;
+		}
+		if( from < 0 || to < from || to >= CPU_SETSIZE ) return FALSE;
+		for( i = from; i <= to && opt.ncpus < CPU_SETSIZE; i++ )
+			opt.cpus[opt.ncpus++] = i;
+		if( ',' == *end ) end++;
+		else if( '\0' != *end ) return FALSE;
+		arg = end;
+	}
+	return 0 < opt.ncpus;
+}
+
+/*
+ * -b bssplit: "4k/60,64k/30,1m/10" blocksize/weight pairs
+ * 	returns FALSE if it is invalid
+ */
+int parse_bssplit(const char * arg)
+{
+	char * end;
+	unsigned long long weight, total = 0;
+
+	for( opt.nbss = 0; '\0' != *arg; opt.nbss++ ){
+		if( BSS_MAX <= opt.nbss ) return FALSE;
+		opt.bss[opt.nbss] = parse_size(arg, &end);
+		if( end == arg || 0 == opt.bss[opt.nbss] || '/' != *end ) return FALSE;
+		arg = end + 1;
+		weight = strtoull(arg, &end, 10);
+		if( end == arg || 0 == weight ) return FALSE;
+		total += weight;
+		opt.bsscum[opt.nbss] = total;
+		if( ',' == *end ) end++;
+		else if( '\0' != *end ) return FALSE;
+		arg = end;
+	}
+	return 0 < opt.nbss;
+}
+
+/*
+ * -B/-Q list: "4k,64k" or ranges "1-64" (doubling), k/m/g suffixes
+ * 	returns the number of the values, 0 if it is invalid
+ */
+int parse_sweeplist(const char * arg, unsigned long long * vals)
+{
+	char * end;
+	unsigned long long from, to, v;
+	int n = 0;
+
+	while( '\0' != *arg ){
+		from = parse_size(arg, &end);
+		if( end == arg ) return 0;
+		to = from;
+		if( '-' == *end ){
+			arg = end + 1;
+			to = parse_size(arg, &end);
+			if( end == arg ) return 0;
+		}
+		if( 0 == from || to < from ) return 0;
+		for( v = from; v <= to; v *= 2 ){
+			if( SWEEP_MAX <= n ) return 0;
+			vals[n++] = v;
+		}
+		if( ',' == *end ) end++;
+		else if( '\0' != *end ) return 0;
+		arg = end;
+	}
+	return n;
+}
+
+/*
+ * pins the calling thread to a cpu, returns 0 or errno
+ */
+int pin_cpu(int cpu)
+{
+	size_t setsize;
+	cpu_set_t *setp;
+	int status;
+
+	setp = CPU_ALLOC(cpu + 1);
+	errh_malloc(setp, "cpuset");
+	setsize = CPU_ALLOC_SIZE(cpu + 1);
+	CPU_ZERO_S(setsize, setp);
+	CPU_SET_S(cpu, setsize, setp);
+	status = sched_setaffinity( 0, setsize, setp);
+	CPU_FREE(setp);
+	return status ? errno : 0;
+}
+
+/*
+ * alloc_buffers
+ * 	called by the worker itself after the pinning: the first touch
+ * 	places the pages on the numa node of the worker. Only once, in the 
+ * 	largest size, the later phases (and sweep points) reuse them.
+ */
+void alloc_buffers(struct iojob * job)
+{
+	char * totbuff = NULL; /* allocated by malloc for 'job->buff' */
+	long long i;
+	unsigned long long j;
+	ssize_t status;
+
+	job->buff=(char **)malloc(opt.nbufs*sizeof(char *) );
+	errh_malloc(job->buff, "array of buffers");
+	job->buffdirty = (char *)calloc(opt.nbufs, sizeof(char));
+	errh_malloc(job->buffdirty, "array of buffer flags");
+	for( i=0 ; i < opt.nbufs ; i ++ ){
+		if( opt.arena ){ /* the slice of the job, touched (placed) here first */
+			job->buff[i] = opt.bufarena.base + (job->id * opt.nbufs + i) * roundup4k(opt.bufsize);
+		}else{
+			totbuff = (char *)malloc(roundup4k(opt.bufsize)+4096);
+			errh_malloc(totbuff, "one of job->buff");
+			job->buff[i] = (char *)roundup4k((unsigned long long)totbuff);
+		}
+
+		if(opt.debug) printf("job %d totbuff=%p buff[%lld]=%p\n",job->id,totbuff,i, job->buff[i]);
+
+		if( opt.compress > 0.0 || opt.dedup > 0.0 ){ /* the zero tails of the generated blocks */
+			memset(job->buff[i], 0, roundup4k(opt.bufsize));
+		} else if( opt.uncompressable ){
+			status=read(opt.rndfh, job->buff[i], roundup4k(opt.bufsize) );
+			if( 0 >= status ) 
+				errh_iogeneric("read( randomfile )", -errno);
+		} else{
+			for(j = 0; j < roundup4k(opt.bufsize) / sizeof(int); j++)
+	       			((unsigned int *)job->buff[i])[j]= MAGIC;
+		} /* end if uncompressable */
+	}
+}
+
+/* 0 if the whole block is the 0xDEADBEEF pattern */
+static inline int check_magic(const char * src, unsigned len)
+{
+	pattern_v8_t m, y, diff;
+	unsigned i;
+
+	for( i = 0; i < 8; i++ )
+		m[i] = MAGIC;
+	diff = m ^ m;
+	for( i = 0; i + PATTERN_VEC <= len; i += PATTERN_VEC ){
+		memcpy(&y, src + i, PATTERN_VEC);
+		diff |= y ^ m;
+	}
+	for( ; i + sizeof(uint32_t) <= len; i += sizeof(uint32_t) )
+		diff[0] |= *(const uint32_t *)(src + i) ^ MAGIC;
+	for( i = 1; i < 8; i++ )
+		diff[0] |= diff[i];
+	return 0 != diff[0];
+}
+
+/* the first bad block of the run: to stderr and to the dump file */
+static void verify_report(struct iojob * job, unsigned long long offset, 
+		const char * buf, unsigned len)
+{
+	int fd;
+
+	if( __atomic_exchange_n(&opt.dumped, TRUE, __ATOMIC_ACQ_REL) )
+		return;
+	fprintf(stderr, "Verify: first bad block at offset %llu (%s, job %d)\n",
+		offset, job->phase->type, job->id);
+	if( NULL == opt.dumpfile ) 
+		return;
+	fd = open(opt.dumpfile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if( 0 > fd || len != write(fd, buf, len) )
+		perror("Warn: cannot dump the bad block");
+	if( 0 <= fd ) close(fd);
+}
+
+/*
+ * verify_slot
+ * 	checks a completed read per 4 KiB block: the generated pattern (-C/-X)
+ * 	or the 0xDEADBEEF pattern entirely, the -u blocks only by the stamp
+ * 	(the rest of them is random)
+ */
+static void verify_slot(struct iojob * job, struct ioslot * slot)
+{
+	unsigned long long ofs, blockno;
+	unsigned len;
+	int bad;
+
+	for( ofs = 0; ofs < (unsigned long long)slot->res; ofs += PATTERN_BLOCK ){
+		len = slot->res - ofs < PATTERN_BLOCK ? slot->res - ofs : PATTERN_BLOCK;
+		blockno = (slot->offset + ofs) >> 12;
+		if( opt.compress > 0.0 || opt.dedup > 0.0 )
+			bad = pattern_check(&opt.pattern, slot->buf + ofs, len, 
+				pattern_key(&opt.pattern, blockno));
+		else if( opt.uncompressable )
+			bad = len < sizeof(uint32_t) || 
+				*(uint32_t *)(slot->buf + ofs) != (uint32_t)blockno;
+		else
+			bad = check_magic(slot->buf + ofs, len);
+		job->verblocks++;
+		if( bad ){
+			job->badblocks++;
+			verify_report(job, slot->offset + ofs, slot->buf + ofs, len);
+		}
+	}
+}
+
+/* one completed slot into the ring of the per io log */
+static inline void iolog_slot(struct iojob * job, const struct ioslot * slot, 
+		unsigned long long nowns)
+{
+	iolog_rec_t rec;
+
+	memset(&rec, 0, sizeof(rec));
+	rec.submitns = slot->submitns;
+	rec.completens = nowns;
+	rec.offset = slot->devoffset;
+	rec.len = slot->len;
+	rec.res = (int32_t)slot->res;
+	rec.job = job->id;
+	rec.op = OP_FLUSH == slot->op ? IOLOG_FLUSH : OP_DISCARD == slot->op ? IOLOG_DISCARD :
+		slot->isread ? IOLOG_READ : IOLOG_WRITE;
+	rec.target = slot->target;
+	rec.phase = opt.phaseno;
+	if( iolog_push(&opt.iologrings[job->id], &rec) )
+		job->iologged++;
+	else
+		job->iologdropped++;
+}
+
+/* -z: only the owner job of the zone gets here */
+static inline void zone_done(struct ioslot * slot, unsigned long long nowns)
+{
+	struct zone * z = &opt.zones[slot->zone];
+
+	z->inflight--;
+	z->ios++;
+	z->bytes += slot->res;
+	z->latns += nowns - slot->submitns;
+	if( 0 == z->firstns || slot->submitns < z->firstns ) z->firstns = slot->submitns;
+	z->lastns = nowns;
+}
+
+/*
+ * the reaped ios (job->done[0..n-1]) into the statistics
+ */
+static inline void complete_ios(struct iojob * job, long n, unsigned long long nowns)
+{
+	long i;
+	int dir;
+	struct substat * st;
+
+	for(i = 0; i < n; i++){
+		if( job->iolog )
+			iolog_slot(job, job->done[i], nowns);
+		if( OP_RW != job->done[i]->op ){ /* flush, discard: only in their own stats */
+			st = &job->opstat[job->done[i]->op - OP_FLUSH];
+			lathist_record(&st->lat, nowns - job->done[i]->submitns);
+			st->ios++;
+			st->bytes += job->done[i]->len;
+			continue;
+		}
+		job->doneios++;
+		lathist_record(job->lat, nowns - job->done[i]->submitns);
+		job->donebytes += job->done[i]->res;
+		if( 0 <= job->done[i]->zone )
+			zone_done(job->done[i], nowns);
+		if( NULL != job->bss ){
+			lathist_record(&job->bss[job->done[i]->bsclass].lat, nowns - job->done[i]->submitns);
+			job->bss[job->done[i]->bsclass].ios++;
+			job->bss[job->done[i]->bsclass].bytes += job->done[i]->res;
+		}
+		if( NULL != job->strst && 0 <= job->done[i]->stream ){
+			lathist_record(&job->strst[job->done[i]->stream].lat, nowns - job->done[i]->submitns);
+			job->strst[job->done[i]->stream].ios++;
+			job->strst[job->done[i]->stream].bytes += job->done[i]->res;
+		}
+		if( NULL != job->tgt ){
+			lathist_record(&job->tgt[job->done[i]->target].lat, nowns - job->done[i]->submitns);
+			job->tgt[job->done[i]->target].ios++;
+			job->tgt[job->done[i]->target].bytes += job->done[i]->res;
+		}
+		if( opt.verify && job->done[i]->isread && 0 < job->done[i]->res )
+			verify_slot(job, job->done[i]);
+		if( job->mixed ){
+			dir = job->done[i]->isread ? DIR_READ : DIR_WRITE;
+			lathist_record(job->dirlat[dir], nowns - job->done[i]->submitns);
+			job->dirios[dir]++;
+			job->dirbytes[dir] += job->done[i]->res;
+		}
+	}
+}
+
+/*
+ * submit_batched
+ * 	the prepared ios go out in submit() calls of at most opt.batchsub ios
+ */
+static long submit_batched(struct iojob * job, struct ioslot ** list, long n)
+{
+	long i, k;
+
+	for( i = 0; i < n; i += k ){
+		k = opt.batchsub && opt.batchsub < n - i ? opt.batchsub : n - i;
+		opt.engine->submit(job, list + i, k);
+		job->batches[0]++;
+	}
+	return n;
+}
+
+/*
+ * job_closedloop
+ * 	job->qd number of concurent io, a new io goes out when one completes
+ *
+ * 	every slot carries its submit time in submitns. The clock is read 
+ * 	once per submit and once per reap, not per io, so the stamping is 
+ * 	cheap at any depth.
+ *
+ * 	-q: the reap waits for opt.batchcomp completions (at most the ios in 
+ * 	flight), the completed slots wait in subq until the ios in flight 
+ * 	drop to opt.iolow, then all of them are refilled at once.
+ */
+void job_closedloop(struct iojob * job)
+{
+	long result;
+	struct ioslot * slot;
+	long i,needsubmit;
+	unsigned long long io_qd;
+	long iopending;
+	long nfree;	/* completed slots in subq, not yet resubmitted */
+	long mincomp, lowwm;
+	unsigned long long nowns;
+	unsigned long long deadline;
+
+	iopending = 0;
+	io_qd = 0;
+	nfree = 0;
+	mincomp = opt.batchcomp < job->qd ? opt.batchcomp : job->qd;
+	lowwm = 0 <= opt.iolow && opt.iolow < job->qd ? opt.iolow : job->qd - 1;
+	deadline = job->beginns + job->runtimens;
+	for(i = 0; i < job->qd; i++){
+		prep_io(job, &job->slots[i]);
+		job->subq[i] = &job->slots[i];
+	}
+
+	/* kezdeti */
+	nowns = now_ns();
+	for(i = 0; i < job->qd; i++)
+		job->subq[i]->submitns = nowns;
+	result = submit_batched(job, job->subq, job->qd);
+	io_qd += result;
+	iopending += result;
+	if(opt.debug==2)printf("\n %12lld %8ld  %ld\n", io_qd, result,iopending);
+	if(opt.debug==3)debug_putpoint(iopending);
+
+	do{
+		/* varakozas */
+		result = engine_reap(job, mincomp < iopending ? mincomp : iopending, 
+			job->qd, job->done, NULL);
+		nowns = now_ns();
+		iopending -= result;
+		if( result ) job->batches[1]++;
+		if(opt.debug){
+			if(opt.debug==2)
+				printf(" %12lld %8ld  %ld\n", io_qd,-result,iopending);
+			if(opt.debug==3)debug_backpoint(result);
+		}
+		complete_ios(job, result, nowns);
+		for(i = 0; i < result; i++)
+			job->subq[nfree++] = job->done[i];
+		/* a 'nfree' ami szabad, a 'job->totio-io_qd' ami hatravan.
+		 * minden viszatertet fel kell dolgozni, de csak a minimumot kell 
+		 * ujra elkuldeni, es csak ha a low watermark alatt vagyunk.
+		*/
+		if( iopending > lowwm )
+			needsubmit = 0;
+		else if( job->runtimens )
+			needsubmit = nowns < deadline ? nfree : 0;
+		else
+			needsubmit=( nfree < (job->totio-io_qd)) ? nfree : job->totio-io_qd;
+		nfree -= needsubmit; /* from the end of subq */
+		for(i =0; i < needsubmit; i++){
+			slot=job->subq[nfree + i]; /* ez a hozza tartozo slot */
+			/* egyedi io */
+			prep_io(job, slot);
+		}
+		if( needsubmit){
+			nowns = now_ns();
+			for(i = 0; i < needsubmit; i++)
+				job->subq[nfree + i]->submitns = nowns;
+			submit_batched(job, job->subq + nfree, needsubmit);
+			io_qd+=needsubmit;
+			iopending+=needsubmit;
+			switch(opt.debug){
+				case 0: break;
+				case 2: printf(" %12lld %8ld  %ld\n",io_qd, 
+						needsubmit,iopending);
+					break;
+				case 3:	debug_putpoint(needsubmit);
+					break;
+				default:
+					if( 0 == ( (io_qd+1) % 65536 )) {
+						putchar('+'); 
+						fflush(stdout);
+					}
+					if( 0 == ( ((io_qd+1) * opt.mbl) & 0x3FFFFFFF )) {
+						printf(" %lldGiB ", ((io_qd+1)* opt.mbl)>>30);
+						fflush(stdout);
+					}
+			}
+
+		}	
+
+	}while( job->runtimens ? nowns < deadline : io_qd < job->totio );
+
+	if( iopending ){
+		result = engine_reap(job, iopending, job->qd, job->done, NULL);
+		job->batches[1]++;
+		complete_ios(job, result, now_ns());
+		iopending -= result; 
+		if(opt.debug==2) printf(" %12lld %8ld  %ld\n", io_qd,-result,iopending);
+	}
+	
+	if( 0 != iopending ){
+		fprintf(stderr, "Error: %ld pending ios found (internal failure)\n",iopending);
+		exit(1);
+	}
+}/* end of job_closedloop */
+
+/* nanoseconds from one scheduled io to the next one */
+static inline unsigned long long next_gap(struct iojob * job)
+{
+	if( job->phase->replay ) /* the trace's timeline */
+		return job->tracegapns;
+	if( opt.poisson ) /* exponential gaps: poisson arrivals */
+		return (unsigned long long)( -log(1.0 - rng_double(&job->rng)) * job->gapns );
+	return (unsigned long long)job->gapns;
+}
+
+/*
+ * job_openloop
+ * 	the ios are scheduled on a fixed timeline (opt.rate or the trace), independent of 
+ * 	the completions. The latency counts from the scheduled time, not from
+ * 	the real submit, so when the device stalls and there is no free slot, 
+ * 	the waiting time shows up in the latency (no coordinated omission).
+ */
+void job_openloop(struct iojob * job)
+{
+	long result;
+	struct ioslot ** freeq; /* stack of the free slots */
+	long nfree, n;
+	long iopending;
+	unsigned long long issued;
+	unsigned long long nowns, nextns, waitns;
+	unsigned long long deadline;
+	struct timespec ts;
+	int stop;
+
+	freeq = (struct ioslot **) calloc(job->qd , sizeof(struct ioslot *));
+	errh_malloc(freeq, "free slot queue");
+	for(nfree = 0; nfree < job->qd; nfree++)
+		freeq[nfree] = &job->slots[job->qd - nfree - 1];
+	prctl(PR_SET_TIMERSLACK, 1UL); /* the sleeps have to be precise */
+
+	iopending = 0;
+	issued = 0;
+	deadline = job->beginns + job->runtimens;
+	nextns = job->beginns + ( job->phase->replay ? job->tracegapns : 0 );
+	stop = FALSE;
+	for(;;){
+		/* every due io goes out, if there is a slot for it */
+		nowns = now_ns();
+		for( n = 0; ! stop && nfree > 0 && nextns <= nowns; n++ ){
+			job->subq[n] = freeq[--nfree];
+			prep_io(job, job->subq[n]);
+			job->subq[n]->submitns = nextns; /* scheduled, not real */
+			issued++;
+			if( OP_RW == job->subq[n]->op ) /* the flushes and discards have no own time */
+				nextns += next_gap(job);
+			stop = job->runtimens ? nextns >= deadline : issued >= job->totio;
+		}
+		if( n ){
+			submit_batched(job, job->subq, n);
+			iopending += n;
+		}
+		if( stop && 0 == iopending ) break;
+
+		if( stop || 0 == nfree ){ /* only a completion helps */
+			result = engine_reap(job, 1, job->qd, job->done, NULL);
+		}else{ /* completion or the next scheduled io, whichever is first */
+			nowns = now_ns();
+			waitns = nextns > nowns ? nextns - nowns : 0;
+			ts.tv_sec = waitns / 1000000000ULL;
+			ts.tv_nsec = waitns % 1000000000ULL;
+			if( 0 == iopending ){
+				nanosleep(&ts, NULL);
+				continue;
+			}
+			result = engine_reap(job, waitns ? 1 : 0, job->qd, job->done, &ts);
+		}
+		if( result ){
+			job->batches[1]++;
+			complete_ios(job, result, now_ns());
+			for(n = 0; n < result; n++)
+				freeq[nfree++] = job->done[n];
+			iopending -= result;
+		}
+		if(opt.debug==2) printf(" %12llu %8ld  %ld\n", issued, result, iopending);
+	}
+	free(freeq);
+}/* end of job_openloop */
+
+static void iolog_write(const char * buf, size_t len)
+{
+	ssize_t status;
+
+	for( ; len; len -= status, buf += status ){
+		status = write(opt.iologfd, buf, len);
+		if( 0 >= status ){
+			fprintf(stderr, "Error: cannot write the io log '%s'", opt.iologfile);
+			perror(" ");
+			exit(1);
+		}
+	}
+}
+
+/*
+ * iolog_writer
+ * 	the thread of the per io log: drains the rings of the jobs and writes 
+ * 	IOLOG_CHUNK bytes at once (the header is IOLOG_HEADER, so they are 
+ * 	aligned), sleeps a millisecond when there is nothing to do
+ */
+void * iolog_writer(void * arg)
+{
+	char * chunk;
+	iolog_rec_t * recs;
+	size_t fill, ofs, len, nbytes;
+	unsigned long long n, got;
+	struct timespec ms = { 0, 1000000L };
+	long w;
+	int stop;
+
+	errh_malloc(0 == posix_memalign((void **)&chunk, 4096, IOLOG_CHUNK) ? chunk : NULL, "io log chunk");
+	recs = (iolog_rec_t *)malloc(IOLOG_RING * sizeof(iolog_rec_t));
+	errh_malloc(recs, "io log records");
+	fill = 0;
+	for(;;){
+		stop = __atomic_load_n(&opt.iologstop, __ATOMIC_ACQUIRE); /* before the last drain */
+		got = 0;
+		for( w = 0; w < opt.njobs; w++ ){
+			n = iolog_pop(&opt.iologrings[w], recs, IOLOG_RING);
+			got += n;
+			nbytes = n * sizeof(iolog_rec_t);
+			for( ofs = 0; ofs < nbytes; ofs += len ){
+				len = IOLOG_CHUNK - fill < nbytes - ofs ? IOLOG_CHUNK - fill : nbytes - ofs;
+				memcpy(chunk + fill, (char *)recs + ofs, len);
+				fill += len;
+				if( IOLOG_CHUNK == fill ){
+					iolog_write(chunk, fill);
+					fill = 0;
+				}
+			}
+		}
+		if( stop && 0 == got ) break;
+		if( 0 == got ) nanosleep(&ms, NULL);
+	}
+	if( fill ) iolog_write(chunk, fill);
+	free(recs);
+	free(chunk);
+	return NULL;
+}
+
+/* opens the per io log, starts its writer */
+void iolog_start(void)
+{
+	char * header;
+	long w;
+	int status;
+
+	opt.iologfd = open(opt.iologfile, O_WRONLY | O_CREAT | O_TRUNC | O_LARGEFILE, 0644);
+	if( 0 > opt.iologfd ){
+		fprintf(stderr, "Error opening the io log '%s'", opt.iologfile);
+		perror(" ");
+		exit(1);
+	}
+	header = (char *)malloc(IOLOG_HEADER);
+	errh_malloc(header, "io log header");
+	iolog_header(header);
+	iolog_write(header, IOLOG_HEADER);
+	free(header);
+	opt.iologrings = (iolog_ring_t *)calloc(opt.njobs, sizeof(iolog_ring_t));
+	errh_malloc(opt.iologrings, "io log rings");
+	for( w = 0; w < opt.njobs; w++ )
+		errh_iogeneric("io log ring", iolog_ring_init(&opt.iologrings[w], IOLOG_RING));
+	opt.iologstop = FALSE;
+	status = pthread_create(&opt.iologtid, NULL, iolog_writer, NULL);
+	if( 0 != status ){
+		fprintf(stderr, "Error: cannot start the io log writer: %s\n", strerror(status));
+		exit(1);
+	}
+}
+
+/* the rest of the rings to the log, and closes it */
+void iolog_stop(void)
+{
+	long w;
+
+	__atomic_store_n(&opt.iologstop, TRUE, __ATOMIC_RELEASE);
+	pthread_join(opt.iologtid, NULL);
+	if( 0 != close(opt.iologfd) ){
+		fprintf(stderr, "Error: cannot close the io log '%s'", opt.iologfile);
+		perror(" ");
+		exit(1);
+	}
+	for( w = 0; w < opt.njobs; w++ )
+		iolog_ring_free(&opt.iologrings[w]);
+	free(opt.iologrings);
+}
+
+/*
+ * job_place
+ * 	the start of every worker: pins the job, notes where it runs, 
+ * 	allocates its buffers
+ */
+static void job_place(struct iojob * job)
+{
+	unsigned int cpu, node;
+	int status;
+
+	if( 0 <= job->cpu ){
+		status = pin_cpu(job->cpu);
+		if( status )
+			fprintf(stderr, "Warn: job %d cannot be pinned to cpu %d: %s\n",
+				job->id, job->cpu, strerror(status));
+	}
+	if( 0 == syscall(SYS_getcpu, &cpu, &node, NULL) ){
+		job->ranoncpu = cpu;
+		job->ranonnode = node;
+	}
+	if( NULL == job->buff ) alloc_buffers(job);
+}
+
+/*
+ * job_begin
+ * 	after the setup of the worker: opens the perf counters, waits for the 
+ * 	other jobs, then takes the baselines of the measurement
+ */
+static void job_begin(struct iojob * job)
+{
+	struct rusage ru;
+	int status;
+
+	if( opt.nperfev ){
+		status = perfcnt_open(&job->perf, opt.perfev, opt.nperfev);
+		if( status )
+			fprintf(stderr, "Warn: no perf counters in job %d: %s\n", job->id, strerror(-status));
+	}
+
+	status = meeting_wait(&opt.startmeet);
+	if( 0 != status ){
+		fprintf(stderr, "Error: job %d start meeting failed\n", job->id);
+		exit(1);
+	}
+	if( opt.nperfev ) perfcnt_start(&job->perf);
+	getrusage(RUSAGE_THREAD, &ru);
+	job->minflt = ru.ru_minflt;
+	job->majflt = ru.ru_majflt;
+	memset(job->sysc, 0, sizeof(job->sysc));
+	memset(job->batches, 0, sizeof(job->batches));
+	job->cpuns = thread_cpu_ns();
+	job->beginns = now_ns();
+}
+
+/*
+ * job_end
+ * 	the end of the measurement: the deltas from the baselines, closes the
+ * 	perf counters, and tells report_intervals() that the job is done
+ */
+static void job_end(struct iojob * job)
+{
+	struct rusage ru;
+
+	job->endns = now_ns();
+	job->cpuns = thread_cpu_ns() - job->cpuns;
+	getrusage(RUSAGE_THREAD, &ru);
+	job->minflt = ru.ru_minflt - job->minflt;
+	job->majflt = ru.ru_majflt - job->majflt;
+	if( opt.nperfev ){
+		perfcnt_stop(&job->perf);
+		perfcnt_close(&job->perf);
+	}
+	__atomic_store_n(&job->finished, TRUE, __ATOMIC_RELEASE);
+}
+
+/*
+ * sub_worker
+ * 	one worker thread: own io context, buffers and slice of the offsets
+ */
+void * sub_worker(void * arg)
+{
+	struct iojob * job = (struct iojob *)arg;
+	long i;
+	int status, t;
+
+	job_place(job);
+	job->slots = (struct ioslot *) calloc(job->qd , sizeof(struct ioslot));
+	errh_malloc(job->slots, "array of struct ioslot");
+	job->subq = (struct ioslot **) calloc(job->qd , sizeof(struct ioslot *));
+	errh_malloc(job->subq, "submit queue");
+	job->done = (struct ioslot **) calloc(job->qd , sizeof(struct ioslot *));
+	errh_malloc(job->done, "reap queue");
+	job->syncq = (struct ioslot **) calloc(job->qd , sizeof(struct ioslot *));
+	errh_malloc(job->syncq, "sync done queue");
+	job->nsync = 0;
+	for( i = 0; i< job->qd; i++){
+		job->slots[i].idx = i;
+		job->slots[i].buf = job->buff[i];
+	}
+	if( (job->phase->rndread || job->phase->rndwrite) && DIST_ZIPF == job->dist )
+		zipf_init(&job->zipf, job->nblocks, opt.zipftheta);
+	
+	for( t = 0; t < opt.ntargets; t++ ){
+		job->fhs[t] = open(opt.fnames[t], 
+			(100 <= job->phase->readpct ? O_RDONLY : 
+			 ( 0 >= job->phase->readpct && ! ( ENG_MAP & opt.engine->flags ) ? O_WRONLY : O_RDWR)) |
+			O_LARGEFILE | opt.rawmode );
+		if( job->fhs[t] <0 ){
+			fprintf(stderr, "Error opening '%s'", opt.fnames[t]);
+			perror(" ");
+			exit(1) ;
+		}
+	}
+	opt.engine->setup(job);
+	if( job->phase->replay ){
+		status = trace_open(&job->trace, opt.tracefile);
+		if( status ){
+			fprintf(stderr, "Error: cannot open the trace '%s': %s\n", opt.tracefile, strerror(-status));
+			exit(1);
+		}
+		job->recvalid = FALSE;
+		replay_fetch(job);
+	}
+
+	job_begin(job);
+	if( job->gapns > 0.0 || ( job->phase->replay && opt.replayspeed > 0.0 ) )
+		job_openloop(job);
+	else
+		job_closedloop(job);
+	
+	for( t = 0; t < opt.ntargets; t++ )
+		fsync(job->fhs[t]); /* az idomeres elott kell lennie, mert van buffer amit ekkor urit*/
+	job_end(job);
+
+	if( NULL != opt.engine->cleanup )
+		opt.engine->cleanup(job);
+	if( job->phase->replay ) 
+		trace_close(&job->trace);
+	for( t = 0; t < opt.ntargets; t++ )
+		close(job->fhs[t]);
+	free(job->slots);
+	free(job->subq);
+	free(job->done);
+	free(job->syncq);
+	return NULL;
+}/* end of sub_worker */
+
+/*
+ * prints the common result fields (without braces)
+ */
+void print_stats(FILE * out, double elapsedtime, unsigned long long ios, 
+		unsigned long long bytes, const lathist_t * lat)
+{
+	fprintf(out, "\"elapsed\":%f, \"ios\":%llu, \"bytes\":%llu, \"byteps\":%f, \"iops\":%f, ",
+		elapsedtime, ios, bytes,
+		(double)bytes / elapsedtime,
+		(double)ios / elapsedtime);
+	lathist_print(out, "lat_us", lat);
+}
+
+static inline double tv_sec(const struct timeval * tv)
+{
+	return (double)tv->tv_sec + (double)tv->tv_usec / 1e6;
+}
+
+/*
+ * the resource usage of the whole process in the run (ru1 - ru0), 
+ * with the main thread and the kernel work done in its name
+ */
+void print_rusage(FILE * out, const struct rusage * ru0, const struct rusage * ru1, 
+		unsigned long long ios)
+{
+	double user, sys;
+
+	user = tv_sec(&ru1->ru_utime) - tv_sec(&ru0->ru_utime);
+	sys = tv_sec(&ru1->ru_stime) - tv_sec(&ru0->ru_stime);
+	fprintf(out, ", \"rusage\":{\"user\":%f, \"sys\":%f, \"cpu_us_per_io\":%.3f, "
+		"\"vol_ctxsw\":%ld, \"invol_ctxsw\":%ld, \"minflt\":%ld, \"majflt\":%ld}",
+		user, sys, ios ? (user + sys) * 1e6 / ios : 0.0,
+		ru1->ru_nvcsw - ru0->ru_nvcsw, ru1->ru_nivcsw - ru0->ru_nivcsw,
+		ru1->ru_minflt - ru0->ru_minflt, ru1->ru_majflt - ru0->ru_majflt);
+}
+
+/* instructions per cycle, if both are counted */
+void print_ipc(FILE * out, const unsigned long long * perfval, const int * perfvalid)
+{
+	int c, cyc = -1, ins = -1;
+
+	for( c = 0; c < opt.nperfev; c++ ){
+		if( 0 == strcmp(perfcnt_events[opt.perfev[c]].name, "cycles") ) cyc = c;
+		if( 0 == strcmp(perfcnt_events[opt.perfev[c]].name, "instructions") ) ins = c;
+	}
+	if( 0 <= cyc && 0 <= ins && perfvalid[cyc] && perfvalid[ins] && perfval[cyc] )
+		fprintf(out, ", \"ipc\":%.3f", (double)perfval[ins] / perfval[cyc]);
+}
+
+/* the summed counters of the jobs */
+void print_perf(FILE * out, const unsigned long long * perfval, const int * perfvalid, 
+		int perfuser, unsigned long long ios)
+{
+	int c;
+
+	fprintf(out, ", \"perf\":{\"scope\":\"%s\"", perfuser ? "user" : "user+kernel");
+	for( c = 0; c < opt.nperfev; c++ ){
+		if( ! perfvalid[c] ){ /* not in every job: the cpu or the kernel does not know it */
+			fprintf(out, ", \"%s\":null", perfcnt_events[opt.perfev[c]].name);
+			continue;
+		}
+		fprintf(out, ", \"%s\":%llu, \"%s_per_io\":%.3f", 
+			perfcnt_events[opt.perfev[c]].name, perfval[c], 
+			perfcnt_events[opt.perfev[c]].name, ios ? (double)perfval[c] / ios : 0.0);
+	}
+	print_ipc(out, perfval, perfvalid);
+	fprintf(out, "}");
+}
+
+/*
+ * -H[event,...]  perf counters, returns FALSE if an event is unknown
+ */
+int parse_perf(const char * arg)
+{
+	size_t len;
+
+	if( '\0' == *arg )
+		arg = "cycles,instructions,cache-misses";
+	for( opt.nperfev = 0; '\0' != *arg; ){
+		len = strcspn(arg, ",");
+		if( PERFCNT_MAX <= opt.nperfev ) return FALSE;
+		opt.perfev[opt.nperfev] = perfcnt_lookup(arg, len);
+		if( 0 > opt.perfev[opt.nperfev++] ) return FALSE;
+		arg += len;
+		if( ',' == *arg ) arg++;
+	}
+	return 0 < opt.nperfev;
+}
+
+/*
+ * report_intervals
+ * 	runs in the main thread while the jobs work, prints a json line in 
+ * 	every opt.intervalms. The histograms of the jobs are read with atomic
+ * 	loads while they record (lathist_snapmerge), the interval is the 
+ * 	difference of two snapshots.
+ */
+void report_intervals(const char * type)
+{
+	lathist_t * cur, * prev, * ival, * tmp;
+	struct timespec tick;
+	unsigned long long startns, prevns, nowns;
+	unsigned long long ios, bytes, previos = 0, prevbytes = 0;
+	long w, n;
+	int running;
+
+	cur = (lathist_t *)malloc(sizeof(lathist_t));
+	prev = (lathist_t *)malloc(sizeof(lathist_t));
+	ival = (lathist_t *)malloc(sizeof(lathist_t));
+	errh_malloc(cur, "latency histogram");
+	errh_malloc(prev, "latency histogram");
+	errh_malloc(ival, "latency histogram");
+	lathist_init(prev);
+
+	clock_gettime(CLOCK_MONOTONIC, &tick);
+	startns = prevns = now_ns();
+	for( n = 1; ; n++ ){
+		tick.tv_nsec += (opt.intervalms % 1000) * 1000000L;
+		tick.tv_sec += opt.intervalms / 1000 + tick.tv_nsec / 1000000000L;
+		tick.tv_nsec %= 1000000000L;
+		while( EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &tick, NULL) )
+			;
+		nowns = now_ns();
+		lathist_init(cur);
+		ios = bytes = 0;
+		running = FALSE;
+		for( w = 0; w < opt.njobs; w++ ){
+			if( ! __atomic_load_n(&opt.jobs[w].finished, __ATOMIC_ACQUIRE) ) running = TRUE;
+			lathist_snapmerge(cur, opt.jobs[w].lat);
+			ios += __atomic_load_n(&opt.jobs[w].doneios, __ATOMIC_RELAXED);
+			bytes += __atomic_load_n(&opt.jobs[w].donebytes, __ATOMIC_RELAXED);
+		}
+		if( ! running ) break;
+		lathist_diff(ival, cur, prev);
+		printf("{\"interval\":%ld, \"type\":\"%s\", \"time\":%f, ", 
+			n, type, (double)(nowns - startns) / 1e9);
+		print_stats(stdout, (double)(nowns - prevns) / 1e9, ios - previos, bytes - prevbytes, ival);
+		printf("}\n");
+		fflush(stdout);
+		tmp = prev; prev = cur; cur = tmp;
+		prevns = nowns;
+		previos = ios;
+		prevbytes = bytes;
+	}
+	free(cur);
+	free(prev);
+	free(ival);
+}
+
+/*
+ * jobs_begin
+ * 	the main thread's side of the start meeting, then the interval reports
+ * 	(if any) until the jobs end; clears the sums, except the histogram
+ */
+static void jobs_begin(struct jobsum * js, const char * type)
+{
+	int status, c;
+
+	status = meeting_wait(&opt.startmeet);
+	errh_iogeneric("meeting_wait", -status);
+	getrusage(RUSAGE_SELF, &js->ru0); /* the setup of the jobs is done */
+	if( opt.intervalms ) report_intervals(type);
+	js->beginns = ~0ULL;
+	js->endns = 0;
+	js->ios = js->bytes = 0;
+	js->cpuns = js->minflt = js->majflt = 0;
+	js->sysc[0] = js->sysc[1] = js->batches[0] = js->batches[1] = 0;
+	memset(js->perfval, 0, sizeof(js->perfval));
+	for( c = 0; c < opt.nperfev; c++ )
+		js->perfvalid[c] = TRUE;
+	js->perfuser = FALSE;
+}
+
+/* adds a joined job to the sums */
+static void jobsum_add(struct jobsum * js, const struct iojob * job)
+{
+	int c;
+
+	js->cpuns += job->cpuns;
+	js->minflt += job->minflt;
+	js->majflt += job->majflt;
+	for( c = 0; c < 2; c++ ){
+		js->sysc[c] += job->sysc[c];
+		js->batches[c] += job->batches[c];
+	}
+	for( c = 0; c < opt.nperfev; c++ ){
+		js->perfval[c] += job->perf.val[c];
+		if( ! job->perf.valid[c] ) js->perfvalid[c] = FALSE;
+	}
+	if( job->perf.useronly ) js->perfuser = TRUE;
+	if( job->beginns < js->beginns ) js->beginns = job->beginns;
+	if( job->endns > js->endns ) js->endns = job->endns;
+	js->ios += job->doneios;
+	js->bytes += job->donebytes;
+	lathist_merge(js->lat, job->lat);
+}
+
+/* after the joins */
+static void jobs_end(struct jobsum * js)
+{
+	getrusage(RUSAGE_SELF, &js->ru1);
+	meeting_destroy(&opt.startmeet);
+}
+
+/*
+ * the cost of the run: every block with the feature it is for, 
+ * and all of them with -H
+ */
+static void print_cost(FILE * out, const struct jobsum * js)
+{
+	/* the jobs' own cpu time: 100% is one core; for the polling */
+	if( opt.poll || opt.nperfev )
+		fprintf(out, ", \"cpu_pct\":%.1f, \"cpu_us_per_io\":%.3f", 
+			js->endns > js->beginns ? 100.0 * js->cpuns / (double)(js->endns - js->beginns) : 0.0,
+			js->ios ? (double)js->cpuns / 1000.0 / js->ios : 0.0);
+	/* the page cache paths (mmap, psync) pay here */
+	if( ( ENG_SYNC & opt.engine->flags ) || opt.nperfev )
+		fprintf(out, ", \"faults\":{\"minor\":%llu, \"major\":%llu, \"per_io\":%.3f}",
+			js->minflt, js->majflt, js->ios ? (double)(js->minflt + js->majflt) / js->ios : 0.0);
+	/* the syscalls of the io path (the engines, not -f), with -q; the batches are
+	 * the mean ios per submit and per reap call of the engine, with or without a
+	 * syscall (uring and -y reap from the ring in userspace) */
+	if( ( opt.batching || opt.nperfev ) && ! opt.meta ){
+		fprintf(out, ", \"syscalls\":{\"submit\":%llu, \"reap\":%llu, \"per_io\":%.3f, "
+			"\"ios_per_submit_batch\":%.2f, \"ios_per_reap_batch\":%.2f", js->sysc[0], js->sysc[1], 
+			js->ios ? (double)(js->sysc[0] + js->sysc[1]) / js->ios : 0.0,
+			js->batches[0] ? (double)js->ios / js->batches[0] : 0.0, 
+			js->batches[1] ? (double)js->ios / js->batches[1] : 0.0);
+		if( opt.batching )
+			fprintf(out, ", \"batch_submit\":%ld, \"batch_complete\":%ld, \"low\":%ld", 
+				opt.batchsub, opt.batchcomp, opt.iolow);
+		fprintf(out, "}");
+	}
+	if( opt.nperfev ){
+		print_rusage(out, &js->ru0, &js->ru1, js->ios);
+		print_perf(out, js->perfval, js->perfvalid, js->perfuser, js->ios);
+	}
+}
+
+/* the per job results, with more than one job */
+static void print_threads(FILE * out)
+{
+	struct iojob * job;
+	long w;
+
+	if( 1 >= opt.njobs ) return;
+	fprintf(out, ", \"threads\":[");
+	for(w = 0; w < opt.njobs; w++){
+		job = &opt.jobs[w];
+		fprintf(out, "%s{\"thread\":%d, \"cpu\":%d, \"node\":%d, ",
+			w ? ", " : "", job->id, job->ranoncpu, job->ranonnode);
+		print_stats(out, (double)(job->endns - job->beginns) / 1e9, 
+			job->doneios, job->donebytes, job->lat);
+		if( opt.poll || opt.nperfev )
+			fprintf(out, ", \"cpu_pct\":%.1f", job->endns > job->beginns ? 
+				100.0 * job->cpuns / (double)(job->endns - job->beginns) : 0.0);
+		fprintf(out, "}");
+	}
+	fprintf(out, "]");
+}
+
+/*
+ * between two phases: optional page cache drop and sleep
+ */
+void sub_betweenphases(void)
+{
+	int fd;
+
+	if( opt.dropcaches ){
+		sync();
+		fd = open("/proc/sys/vm/drop_caches", O_WRONLY);
+		if( fd < 0 || 1 != write(fd, "3", 1) )
+			perror("Warn: cannot drop the caches (/proc/sys/vm/drop_caches)");
+		if( fd >= 0 ) close(fd);
+		if(opt.debug){printf(" caches dropped\n");fflush(stdout);}
+	}
+	if( opt.phasesleep ){
+		if(opt.debug){printf(" sleeping %d sec\n", opt.phasesleep);fflush(stdout);}
+		sleep(opt.phasesleep);
+	}
+}
+
+static const struct phase replayphase = { .type = "replay", .readpct = 50, .replay = TRUE };
+static const struct phase metaphase = { .type = "metadata", .meta = TRUE };
+
+static const struct phase phases[] = {
+	{ .type = "seqwrite", .readpct = 0 },
+	{ .type = "rndwrite", .readpct = 0, .rndwrite = TRUE },
+	{ .type = "seqread", .readpct = 100 },
+	{ .type = "rndread", .readpct = 100, .rndread = TRUE }
+};
+
+/*
+ * sub_doio
+ * 	starts opt.njobs workers at the same time, and prints the aggregate 
+ * 	(and per worker) results as one json object to 'out'. 
+ * 	The aggregate goes to 'sum' too, if it is not NULL.
+ */
+void sub_doio(const struct phase * phase, FILE * out, struct runsum * sum)
+{
+	struct iojob * job;
+	long w;
+	int status, dir;
+	unsigned long long startio;
+	unsigned long long nblocks = 0;
+	unsigned long long align;
+	unsigned long long totio, runtimens;
+	unsigned long long dirios[2], dirbytes[2];
+	unsigned long long verblocks, badblocks;
+	unsigned long long iologged, iologdropped;
+	struct jobsum js;
+	struct timeval starttime;
+	lathist_t * dirlat[2];
+	struct substat * tgt = NULL;
+	struct substat * bss = NULL;
+	lathist_t * origlat = NULL;
+	struct substat * opstat = NULL;
+	struct substat * strst = NULL;
+	unsigned long long part;
+	unsigned long long zresets;
+	struct zone * z;
+	long zi;
+	unsigned long nodepages[ARENA_MAXNODES];
+	long present;
+	int mixed, t, c, extras, seqstreams, zwrites;
+
+	if(opt.debug){fprintf(stdout,"\n sub_doio start: %s (%s, %d jobs)\n",
+			phase->type, opt.engine->name, opt.njobs); 
+		fflush(stdout);}
+
+	mixed = 0 < phase->readpct && phase->readpct < 100;
+	extras = ( opt.flushn || opt.flushbytes || opt.discardn ) && phase->readpct < 100 && ! phase->precond;
+	zwrites = NULL != opt.zones && phase->readpct < 100;
+	seqstreams = opt.nstreams && ! phase->replay && ! phase->precond &&
+		( ( 0 < phase->readpct && ! phase->rndread ) || ( phase->readpct < 100 && ! phase->rndwrite ) );
+	align = opt.align && ! phase->precond ? opt.align : opt.mbl;
+	totio = opt.totio;
+	runtimens = opt.runtimens;
+	if( phase->precond ){ /* the whole target: filled by iocount, the steady rounds by time */
+		totio = gettargetsize() / opt.mbl;
+		runtimens = phase->rndwrite ? opt.pcroundns : 0;
+		if( totio < opt.njobs ){
+			fprintf(stderr, "Error: '%s' is smaller than one block per job\n", opt.fname);
+			exit(1);
+		}
+	}
+	if(phase->rndread || phase->rndwrite){
+		opt.filesize=gettargetsize();
+		nblocks = opt.filesize/align;
+		if( nblocks < (opt.sharedrnd ? 1 : opt.njobs) ||
+		    ( opt.sharedrnd ? nblocks : nblocks / opt.njobs ) * align < opt.bufsize ){
+			fprintf(stderr, "Error: '%s' is smaller than one block per job\n", opt.fname);
+			exit(1);
+		}
+	}
+	js.lat = (lathist_t *)malloc(sizeof(lathist_t));
+	errh_malloc(js.lat, "latency histogram");
+	lathist_init(js.lat);
+	for(dir = DIR_READ; dir <= DIR_WRITE; dir++){
+		dirlat[dir] = (lathist_t *)malloc(sizeof(lathist_t));
+		errh_malloc(dirlat[dir], "latency histogram");
+		lathist_init(dirlat[dir]);
+		dirios[dir] = dirbytes[dir] = 0;
+	}
+	if( phase->replay ){
+		origlat = (lathist_t *)malloc(sizeof(lathist_t));
+		errh_malloc(origlat, "latency histogram");
+		lathist_init(origlat);
+	}
+	if( opt.nbss && ! phase->replay && ! phase->precond ){
+		bss = (struct substat *)malloc(opt.nbss * sizeof(struct substat));
+		errh_malloc(bss, "blocksize class statistics");
+		for( c = 0; c < opt.nbss; c++ ){
+			lathist_init(&bss[c].lat);
+			bss[c].ios = bss[c].bytes = 0;
+		}
+	}
+	if( 1 < opt.ntargets ){
+		tgt = (struct substat *)malloc(opt.ntargets * sizeof(struct substat));
+		errh_malloc(tgt, "target statistics");
+		for( t = 0; t < opt.ntargets; t++ ){
+			lathist_init(&tgt[t].lat);
+			tgt[t].ios = tgt[t].bytes = 0;
+		}
+	}
+	if( seqstreams ){
+		strst = (struct substat *)malloc(opt.nstreams * sizeof(struct substat));
+		errh_malloc(strst, "stream statistics");
+		for( c = 0; c < opt.nstreams; c++ ){
+			lathist_init(&strst[c].lat);
+			strst[c].ios = strst[c].bytes = 0;
+		}
+	}
+	if( extras ){
+		opstat = (struct substat *)malloc(2 * sizeof(struct substat));
+		errh_malloc(opstat, "flush and discard statistics");
+		for( c = 0; c < 2; c++ ){
+			lathist_init(&opstat[c].lat);
+			opstat[c].ios = opstat[c].bytes = 0;
+		}
+	}
+
+	for( zi = 0; zwrites && zi < opt.nzones; zi++ ){
+		z = &opt.zones[zi];
+		z->open = FALSE;
+		z->inflight = 0;
+		z->ios = z->bytes = z->latns = z->firstns = z->lastns = 0;
+	}
+
+	gettimeofday(&starttime, NULL);
+	status = meeting_init(&opt.startmeet, opt.njobs + 1);
+	errh_iogeneric("meeting_init", -status);
+	startio = 0;
+	for(w = 0; w < opt.njobs; w++){
+		job = &opt.jobs[w];
+		job->phase = phase;
+		job->totio = totio / opt.njobs + ( w < totio % opt.njobs ? 1 : 0);
+		job->runtimens = runtimens;
+		job->qd = opt.threadcnt < job->totio ? opt.threadcnt : job->totio;
+		job->seqstart = startio * opt.mbl; /* seq: consecutive slices */
+		job->nextoffset[DIR_READ] = job->nextoffset[DIR_WRITE] = job->seqstart;
+		startio += job->totio;
+		job->seqend = startio * opt.mbl;
+		job->doneios = job->donebytes = 0;
+		job->verblocks = job->badblocks = 0;
+		job->iologged = job->iologdropped = 0;
+		job->sinceflush = job->bytessinceflush = job->sincediscard = 0;
+		job->nflush = 0;
+		for( c = 0; c < 2; c++ ){
+			lathist_init(&job->opstat[c].lat);
+			job->opstat[c].ios = job->opstat[c].bytes = 0;
+		}
+		job->finished = FALSE;
+		job->mixed = mixed;
+		job->extras = extras;
+		job->dist = phase->precond ? DIST_UNIFORM : opt.dist;
+		job->iolog = NULL != opt.iologfile && ! phase->precond; /* its rings are not there yet */
+		for(dir = DIR_READ; dir <= DIR_WRITE; dir++){
+			job->dirlat[dir] = NULL;
+			job->dirios[dir] = job->dirbytes[dir] = 0;
+			if( ! mixed ) continue;
+			job->dirlat[dir] = (lathist_t *)malloc(sizeof(lathist_t));
+			errh_malloc(job->dirlat[dir], "latency histogram");
+			lathist_init(job->dirlat[dir]);
+		}
+		if( opt.sharedrnd ){
+			job->firstblock = 0;
+			job->nblocks = nblocks;
+		}else{
+			job->firstblock = w * (nblocks / opt.njobs);
+			job->nblocks = nblocks / opt.njobs;
+		}
+		job->align = align;
+		rng_seed(&job->rng, opt.seed + w);
+		job->streams = NULL;
+		job->strst = NULL;
+		if( seqstreams ){ /* evenly spaced parts of the slice, or random starts in the whole slice */
+			part = (job->seqend - job->seqstart) / opt.nstreams / opt.mbl * opt.mbl;
+			if( part < opt.bufsize ){
+				fprintf(stderr, "Error: less than one block per stream (-N) in job %ld\n", w);
+				exit(1);
+			}
+			job->streams = (struct stream *)malloc(opt.nstreams * sizeof(struct stream));
+			errh_malloc(job->streams, "array of streams");
+			job->strst = (struct substat *)malloc(opt.nstreams * sizeof(struct substat));
+			errh_malloc(job->strst, "stream statistics");
+			for( c = 0; c < opt.nstreams; c++ ){
+				if( opt.streamrnd ){
+					job->streams[c].begin = job->seqstart;
+					job->streams[c].end = job->seqend;
+					job->streams[c].start = job->seqstart + opt.mbl *
+						rng_below(&job->rng, (job->seqend - job->seqstart) / opt.mbl);
+				}else{
+					job->streams[c].begin = job->streams[c].start = job->seqstart + c * part;
+					job->streams[c].end = job->streams[c].begin + part;
+				}
+				job->streams[c].next[DIR_READ] = job->streams[c].next[DIR_WRITE] = job->streams[c].start;
+				lathist_init(&job->strst[c].lat);
+				job->strst[c].ios = job->strst[c].bytes = 0;
+			}
+			job->nextstream = 0;
+		}
+		job->zcur = NULL;
+		job->zresets = 0;
+		if( zwrites ){ /* the zones of the job: w, w + njobs, ... */
+			job->nzcur = opt.zopen && opt.zopen < job->qd ? opt.zopen : job->qd;
+			if( job->nzcur < job->qd ){ /* one write in flight per zone: no reordering in the kernel */
+				if( 0 == w )
+					fprintf(stderr, "Warn: -z%d: the threadcount is %d in the phases with writes\n", 
+						job->nzcur, job->nzcur);
+				job->qd = job->nzcur;
+			}
+			if( ( opt.nzones - w + opt.njobs - 1 ) / opt.njobs < job->nzcur ){
+				fprintf(stderr, "Error: %ld zones are too few for %d jobs with %d open zones\n", 
+					opt.nzones, opt.njobs, job->nzcur);
+				exit(1);
+			}
+			job->zcur = (long *)malloc(job->nzcur * sizeof(long));
+			errh_malloc(job->zcur, "array of open zones");
+			for( c = 0; c < job->nzcur; c++ )
+				job->zcur[c] = -1;
+			job->znext = w;
+		}
+		job->gapns = opt.rate > 0.0 && ! phase->precond ? 1e9 * opt.njobs / opt.rate : 0.0;
+		job->lat = (lathist_t *)malloc(sizeof(lathist_t));
+		errh_malloc(job->lat, "latency histogram");
+		lathist_init(job->lat);
+		job->origlat = NULL;
+		if( phase->replay ){
+			job->origlat = (lathist_t *)malloc(sizeof(lathist_t));
+			errh_malloc(job->origlat, "latency histogram");
+			lathist_init(job->origlat);
+		}
+		job->bss = NULL;
+		if( NULL != bss ){
+			job->bss = (struct substat *)malloc(opt.nbss * sizeof(struct substat));
+			errh_malloc(job->bss, "blocksize class statistics");
+			for( c = 0; c < opt.nbss; c++ ){
+				lathist_init(&job->bss[c].lat);
+				job->bss[c].ios = job->bss[c].bytes = 0;
+			}
+		}
+		job->tgt = NULL;
+		if( 1 < opt.ntargets ){
+			job->tgt = (struct substat *)malloc(opt.ntargets * sizeof(struct substat));
+			errh_malloc(job->tgt, "target statistics");
+			for( t = 0; t < opt.ntargets; t++ ){
+				lathist_init(&job->tgt[t].lat);
+				job->tgt[t].ios = job->tgt[t].bytes = 0;
+			}
+		}
+		status = pthread_create(&job->tid, NULL, sub_worker, job);
+		if( 0 != status ){
+			fprintf(stderr, "Error: cannot start job %ld: %s\n", w, strerror(status));
+			exit(1);
+		}
+	}
+	jobs_begin(&js, phase->type);
+	verblocks = badblocks = 0;
+	iologged = iologdropped = 0;
+	zresets = 0;
+	for(w = 0; w < opt.njobs; w++){
+		pthread_join(opt.jobs[w].tid, NULL);
+		jobsum_add(&js, &opt.jobs[w]);
+		zresets += opt.jobs[w].zresets;
+		iologged += opt.jobs[w].iologged;
+		iologdropped += opt.jobs[w].iologdropped;
+		verblocks += opt.jobs[w].verblocks;
+		badblocks += opt.jobs[w].badblocks;
+		if( NULL != origlat ) 
+			lathist_merge(origlat, opt.jobs[w].origlat);
+		for( c = 0; NULL != bss && c < opt.nbss; c++ ){
+			lathist_merge(&bss[c].lat, &opt.jobs[w].bss[c].lat);
+			bss[c].ios += opt.jobs[w].bss[c].ios;
+			bss[c].bytes += opt.jobs[w].bss[c].bytes;
+		}
+		for( t = 0; NULL != tgt && t < opt.ntargets; t++ ){
+			lathist_merge(&tgt[t].lat, &opt.jobs[w].tgt[t].lat);
+			tgt[t].ios += opt.jobs[w].tgt[t].ios;
+			tgt[t].bytes += opt.jobs[w].tgt[t].bytes;
+		}
+		for( c = 0; NULL != strst && c < opt.nstreams; c++ ){
+			lathist_merge(&strst[c].lat, &opt.jobs[w].strst[c].lat);
+			strst[c].ios += opt.jobs[w].strst[c].ios;
+			strst[c].bytes += opt.jobs[w].strst[c].bytes;
+		}
+		for( c = 0; NULL != opstat && c < 2; c++ ){
+			lathist_merge(&opstat[c].lat, &opt.jobs[w].opstat[c].lat);
+			opstat[c].ios += opt.jobs[w].opstat[c].ios;
+			opstat[c].bytes += opt.jobs[w].opstat[c].bytes;
+		}
+		for(dir = DIR_READ; mixed && dir <= DIR_WRITE; dir++){
+			dirios[dir] += opt.jobs[w].dirios[dir];
+			dirbytes[dir] += opt.jobs[w].dirbytes[dir];
+			lathist_merge(dirlat[dir], opt.jobs[w].dirlat[dir]);
+		}
+	}
+	jobs_end(&js);
+	opt.badblocks += badblocks;
+
+	fprintf(out, "{\"start\":%ld.%06ld, \"threadcount\":%lld, \"jobs\":%d, \"blocksize\":%lld, \"iocount\":%lld, \"seed\":%llu, ", 
+            starttime.tv_sec, starttime.tv_usec,
+            opt.threadcnt, opt.njobs, opt.nbss ? opt.blocksize : opt.mbl, totio, opt.seed);
+	if( runtimens )
+		fprintf(out, "\"runtime\":%f, ", (double)runtimens / 1e9);
+	if( NULL != bss ){
+		fprintf(out, "\"bssplit\":[");
+		for( c = 0; c < opt.nbss; c++ )
+			fprintf(out, "%s{\"size\":%llu, \"weight\":%llu}", c ? ", " : "", opt.bss[c], 
+				opt.bsscum[c] - ( c ? opt.bsscum[c - 1] : 0 ));
+		fprintf(out, "], \"mean_blocksize\":%llu, ", opt.mbl);
+	}
+	if( opt.align && ! phase->precond )
+		fprintf(out, "\"align\":%llu, ", opt.align);
+	if( opt.compress > 0.0 || opt.dedup > 0.0 )
+		fprintf(out, "\"compress\":%f, \"dedup\":%f, ", 
+			opt.compress > 0.0 ? opt.compress : 1.0, opt.dedup > 0.0 ? opt.dedup : 1.0);
+	if( opt.rate > 0.0 && ! phase->precond )
+		fprintf(out, "\"rate\":%f, \"arrival\":\"%s\", ", opt.rate, opt.poisson ? "poisson" : "fixed");
+	fprintf(out, "\"engine\":\"%s\", ", opt.engine->name);
+	if( opt.arena ){ /* where the pages of the buffers are, sampled */
+		fprintf(out, "\"buffers\":{\"size\":%zu, \"page\":%zu, \"hugetlb_fallback\":%s, \"bind\":%d, "
+			"\"device_node\":%d, \"nodes\":[", opt.bufarena.size, opt.bufarena.pagesize, 
+			opt.bufarena.fallback ? "true" : "false", opt.bufarena.node, opt.devnode);
+		present = arena_nodes(&opt.bufarena, nodepages);
+		for( c = 0, t = 0; c < ARENA_MAXNODES && 0 < present; c++ )
+			if( nodepages[c] )
+				fprintf(out, "%s{\"node\":%d, \"pages\":%lu}", t++ ? ", " : "", c, nodepages[c]);
+		fprintf(out, "], \"sampled_pages\":%ld}, ", present);
+	}
+	if( opt.poll )
+		fprintf(out, "\"poll\":\"%s\", ", opt.iopoll ? "iopoll" : "spin");
+	fprintf(out, "\"type\":\"%s\", ", phase->type);
+	if( phase->replay ){
+		fprintf(out, "\"trace\":\"%s\", \"replay\":\"%s\", ", opt.tracefile, 
+			opt.replayspeed > 0.0 ? "timed" : "fast");
+		if( opt.replayspeed > 0.0 )
+			fprintf(out, "\"speed\":%f, ", opt.replayspeed);
+	}
+	if( mixed && ! phase->replay )
+		fprintf(out, "\"readpct\":%d, \"mix\":\"%sread+%swrite\", ", phase->readpct,
+			phase->rndread ? "rnd" : "seq", phase->rndwrite ? "rnd" : "seq");
+	if( NULL != strst )
+		fprintf(out, "\"nstreams\":%d, \"stream_start\":\"%s\", ", opt.nstreams, 
+			opt.streamrnd ? "random" : "even");
+	print_stats(out, (double)(js.endns - js.beginns) / 1e9, js.ios, js.bytes, js.lat);
+	print_cost(out, &js);
+	for(dir = DIR_READ; mixed && dir <= DIR_WRITE; dir++){
+		fprintf(out, ", \"%s\":{", DIR_READ == dir ? "read" : "write");
+		print_stats(out, (double)(js.endns - js.beginns) / 1e9, dirios[dir], dirbytes[dir], dirlat[dir]);
+		fprintf(out, "}");
+	}
+	if( NULL != opstat && ( opt.flushn || opt.flushbytes ) ){
+		fprintf(out, ", \"flush\":{\"op\":\"%s\", ", opt.flushfull ? "fsync" : "fdatasync");
+		if( opt.flushn ) fprintf(out, "\"every_writes\":%llu, ", opt.flushn);
+		if( opt.flushbytes ) fprintf(out, "\"every_bytes\":%llu, ", opt.flushbytes);
+		print_stats(out, (double)(js.endns - js.beginns) / 1e9, opstat[0].ios, opstat[0].bytes, &opstat[0].lat);
+		fprintf(out, "}");
+	}
+	if( NULL != opstat && opt.discardn ){
+		fprintf(out, ", \"discard\":{\"every_ios\":%llu, \"length\":%llu, ", 
+			opt.discardn, opt.discardlen ? opt.discardlen : opt.mbl);
+		print_stats(out, (double)(js.endns - js.beginns) / 1e9, opstat[1].ios, opstat[1].bytes, &opstat[1].lat);
+		fprintf(out, "}");
+	}
+	if( NULL != opt.iologfile && ! phase->precond )
+		fprintf(out, ", \"iolog\":{\"file\":\"%s\", \"phase\":%d, \"records\":%llu, \"dropped\":%llu}",
+			opt.iologfile, opt.phaseno & 0xff, iologged, iologdropped);
+	if( opt.verify && 0 < phase->readpct )
+		fprintf(out, ", \"verify\":{\"blocks\":%llu, \"bad\":%llu}", verblocks, badblocks);
+	if( NULL != origlat && origlat->cnt ){ /* the latencies of the trace, and the ratios */
+		fprintf(out, ", ");
+		lathist_print(out, "orig_lat_us", origlat);
+		fprintf(out, ", \"lat_vs_orig\":{\"mean\":%f, \"p50\":%f, \"p99\":%f}",
+			js.lat->cnt ? ((double)js.lat->sum / js.lat->cnt) / ((double)origlat->sum / origlat->cnt) : 0.0,
+			(double)lathist_percentile(js.lat, 50.0) / (double)lathist_percentile(origlat, 50.0),
+			(double)lathist_percentile(js.lat, 99.0) / (double)lathist_percentile(origlat, 99.0));
+	}
+	if( NULL != bss ){
+		fprintf(out, ", \"sizes\":[");
+		for( c = 0; c < opt.nbss; c++ ){
+			fprintf(out, "%s{\"size\":%llu, ", c ? ", " : "", opt.bss[c]);
+			print_stats(out, (double)(js.endns - js.beginns) / 1e9, bss[c].ios, bss[c].bytes, &bss[c].lat);
+			fprintf(out, "}");
+		}
+		fprintf(out, "]");
+	}
+	if( NULL != strst ){ /* stream c of every job */
+		fprintf(out, ", \"streams\":[");
+		for( c = 0; c < opt.nstreams; c++ ){
+			fprintf(out, "%s{\"stream\":%d, ", c ? ", " : "", c);
+			print_stats(out, (double)(js.endns - js.beginns) / 1e9, strst[c].ios, strst[c].bytes, &strst[c].lat);
+			fprintf(out, "}");
+		}
+		fprintf(out, "]");
+	}
+	if( zwrites ){ /* the written zones only */
+		fprintf(out, ", \"zones\":{\"zones\":%ld, \"zone_size\":%llu, \"open_per_job\":%d, "
+			"\"resets\":%llu, \"written\":[", opt.nzones, (unsigned long long)opt.zones[0].z.len,
+			opt.jobs[0].nzcur, zresets);
+		for( zi = 0, c = 0; zi < opt.nzones; zi++ ){
+			z = &opt.zones[zi];
+			if( 0 == z->ios ) continue;
+			fprintf(out, "%s{\"zone\":%u, \"start\":%llu, \"wp\":%llu, \"ios\":%llu, \"bytes\":%llu, "
+				"\"elapsed\":%f, \"byteps\":%f, \"mean_us\":%.3f}", c++ ? ", " : "", 
+				z->z.no, (unsigned long long)z->z.start, (unsigned long long)z->z.wp, z->ios, z->bytes,
+				(double)(z->lastns - z->firstns) / 1e9,
+				z->lastns > z->firstns ? (double)z->bytes * 1e9 / (z->lastns - z->firstns) : 0.0,
+				(double)z->latns / z->ios / 1000.0);
+		}
+		fprintf(out, "]}");
+	}
+	if( NULL != tgt ){
+		fprintf(out, ", \"targets\":[");
+		for( t = 0; t < opt.ntargets; t++ ){
+			fprintf(out, "%s{\"target\":\"%s\", ", t ? ", " : "", opt.fnames[t]);
+			print_stats(out, (double)(js.endns - js.beginns) / 1e9, tgt[t].ios, tgt[t].bytes, &tgt[t].lat);
+			fprintf(out, "}");
+		}
+		fprintf(out, "]");
+	}
+	print_threads(out);
+	fprintf(out, "}");
+	fflush(out);
+	if( NULL != sum ){
+		sum->threadcnt = opt.threadcnt;
+		sum->elapsed = (double)(js.endns - js.beginns) / 1e9;
+		sum->ios = js.ios;
+		sum->bytes = js.bytes;
+		sum->meanns = js.lat->cnt ? (double)js.lat->sum / (double)js.lat->cnt : 0.0;
+		sum->pctns = opt.kneepct > 0.0 ? (double)lathist_percentile(js.lat, opt.kneepct) : sum->meanns;
+	}
+
+	for(w = 0; w < opt.njobs; w++){
+		free(opt.jobs[w].lat);
+		free(opt.jobs[w].dirlat[DIR_READ]);
+		free(opt.jobs[w].dirlat[DIR_WRITE]);
+		free(opt.jobs[w].tgt);
+		free(opt.jobs[w].bss);
+		free(opt.jobs[w].origlat);
+		free(opt.jobs[w].streams);
+		free(opt.jobs[w].strst);
+		free(opt.jobs[w].zcur);
+	}
+	free(tgt);
+	free(strst);
+	free(opstat);
+	free(bss);
+	free(origlat);
+	free(js.lat);
+	free(dirlat[DIR_READ]);
+	free(dirlat[DIR_WRITE]);
+	if( ! phase->precond ) opt.phaseno++; /* the phase number in the io log */
+	if(opt.debug){fprintf(stdout," sub_doio end "); fflush(stdout);}
+	
+}/* end of sub_doio */
+
+/*
+ * sub_sweep
+ * 	runs the phase on every blocksize x threadcount point (each for opt.runtimens),
+ * 	prints the results as a matrix (one row per blocksize) and the knee point of
+ * 	every row: the last threadcount before the latency (opt.kneepct percentile,
+ * 	or the mean) rises faster than the throughput
+ */
+void sub_sweep(const struct phase * phase, FILE * out)
+{
+	struct runsum * sums, * cur, * prev;
+	unsigned long long savembl, savetotio;
+	long long savethreadcnt;
+	int b, q, knee;
+
+	savembl = opt.mbl;
+	savethreadcnt = opt.threadcnt;
+	savetotio = opt.totio;
+	sums = (struct runsum *)calloc(opt.nsweepbs * opt.nsweepqd, sizeof(struct runsum));
+	errh_malloc(sums, "sweep results");
+
+	fprintf(out, "{\"sweep\":\"%s\", \"blocksizes\":[", phase->type);
+	for( b = 0; b < opt.nsweepbs; b++ )
+		fprintf(out, "%s%llu", b ? ", " : "", opt.sweepbs[b]);
+	fprintf(out, "], \"threadcounts\":[");
+	for( q = 0; q < opt.nsweepqd; q++ )
+		fprintf(out, "%s%llu", q ? ", " : "", opt.sweepqd[q]);
+	fprintf(out, "], \"matrix\":[");
+	for( b = 0; b < opt.nsweepbs; b++ ){
+		fprintf(out, "%s[", b ? ", " : "");
+		for( q = 0; q < opt.nsweepqd; q++ ){
+			if( b || q ) sub_betweenphases();
+			opt.mbl = opt.sweepbs[b];
+			opt.totio = opt.datasize / opt.mbl;
+			if( opt.totio < opt.njobs ){
+				fprintf(stderr,"Err: datasize is smaller than %d blocks of %llu\n", 
+					opt.njobs, opt.mbl);
+				exit(1);
+			}
+			opt.threadcnt = opt.sweepqd[q];
+			if( opt.threadcnt > opt.totio / opt.njobs )
+				opt.threadcnt = opt.totio / opt.njobs;
+			if(opt.debug){printf(" sweep point: blocksize=%llu threadcount=%lld\n", 
+				opt.mbl, opt.threadcnt);fflush(stdout);}
+			if( q ) fprintf(out, ", ");
+			sub_doio(phase, out, &sums[b * opt.nsweepqd + q]);
+		}
+		fprintf(out, "]");
+	}
+
+	if( opt.kneepct > 0.0 )
+		fprintf(out, "], \"knee_on\":\"p%g\", \"knee\":[", opt.kneepct);
+	else
+		fprintf(out, "], \"knee_on\":\"mean\", \"knee\":[");
+	for( b = 0; b < opt.nsweepbs; b++ ){
+		for( knee = 0, q = 1; q < opt.nsweepqd; q++, knee++ ){
+			cur = &sums[b * opt.nsweepqd + q];
+			prev = cur - 1;
+			if( 0 == prev->ios || 0.0 >= prev->pctns || 0.0 >= cur->elapsed )
+				continue;
+			/* relative growth of the latency vs. of the iops */
+			if( (cur->pctns - prev->pctns) / prev->pctns >
+			    ((double)cur->ios / cur->elapsed - (double)prev->ios / prev->elapsed) /
+			    ((double)prev->ios / prev->elapsed) )
+				break;
+		}
+		cur = &sums[b * opt.nsweepqd + knee];
+		fprintf(out, "%s{\"blocksize\":%llu, \"threadcount\":%lld, \"iops\":%f, "
+			"\"byteps\":%f, \"mean_us\":%.3f",
+			b ? ", " : "", opt.sweepbs[b], cur->threadcnt,
+			cur->elapsed > 0.0 ? (double)cur->ios / cur->elapsed : 0.0,
+			cur->elapsed > 0.0 ? (double)cur->bytes / cur->elapsed : 0.0,
+			cur->meanns / 1000.0);
+		if( opt.kneepct > 0.0 )
+			fprintf(out, ", \"p%g_us\":%.3f", opt.kneepct, cur->pctns / 1000.0);
+		fprintf(out, "}");
+	}
+	fprintf(out, "]}");
+	fflush(out);
+
+	free(sums);
+	opt.mbl = savembl;
+	opt.threadcnt = savethreadcnt;
+	opt.totio = savetotio;
+}/* end of sub_sweep */
+
+/*
+ * metadata workload (-f)
+ * 	the jobs churn small files in opt.mdirs directories under the target
+ * 	directory. Every op is synchronous: one syscall, or open, syscall and
+ * 	close, the latency is measured over all of them. The directories are
+ * 	shared, but a job touches only its own files (j<id>.<seq>), so the
+ * 	jobs meet in the directory locks and in the journal only.
+ */
+void errh_meta(const char * what, const char * path)
+{
+	fprintf(stderr, "Error: %s '%s'", what, path);
+	perror(" ");
+	exit(1);
+}
+
+static inline void meta_path(char * buf, const struct iojob * job, const struct mfile * f)
+{
+	snprintf(buf, PATH_MAX, "%s/d%u/j%d.%llu", opt.fnames[0], f->dir, job->id, f->seq);
+}
+
+/* a new name in a random directory, at the end of job->mf */
+static struct mfile * meta_newfile(struct iojob * job)
+{
+	struct mfile * f;
+
+	if( job->nmf == job->mfcap ){
+		job->mfcap = job->mfcap ? 2 * job->mfcap : 1024;
+		job->mf = (struct mfile *)realloc(job->mf, job->mfcap * sizeof(struct mfile));
+		errh_malloc(job->mf, "array of files");
+	}
+	f = &job->mf[job->nmf++];
+	f->dir = rng_below(&job->rng, opt.mdirs);
+	f->seq = job->mfseq++;
+	f->nwrites = 0;
+	return f;
+}
+
+/*
+ * one op on a random file of the job (a create, if it has none),
+ * returns the written bytes, *mop is the op done
+ */
+static unsigned long long meta_op(struct iojob * job, int * mop)
+{
+	char path[PATH_MAX];
+	char newpath[PATH_MAX];
+	struct stat st;
+	struct mfile * f;
+	unsigned long long i;
+	ssize_t res = 0;
+	int fd;
+
+	if( 0 == job->nmf ) *mop = MOP_CREATE;
+	if( MOP_CREATE == *mop ){
+		meta_path(path, job, meta_newfile(job));
+		fd = open(path, O_CREAT | O_EXCL | O_WRONLY, 0644);
+		if( 0 > fd ) errh_meta("create", path);
+		close(fd);
+		return 0;
+	}
+	i = rng_below(&job->rng, job->nmf);
+	f = &job->mf[i];
+	meta_path(path, job, f);
+	switch( *mop ){
+		case MOP_WRITE: /* appends like a spool, then rewrites from the start: bounded size */
+			fd = open(path, O_WRONLY);
+			if( 0 > fd ) errh_meta("open", path);
+			res = pwrite(fd, job->buff[0], opt.mbl, (f->nwrites++ % MFILE_BLOCKS) * opt.mbl);
+			if( (ssize_t)opt.mbl != res ) errh_meta("write", path);
+			close(fd);
+			break;
+		case MOP_FSYNC:
+			fd = open(path, O_WRONLY);
+			if( 0 > fd || 0 > fsync(fd) ) errh_meta("fsync", path);
+			close(fd);
+			break;
+		case MOP_RENAME: /* new name, maybe in an other directory */
+			f->dir = rng_below(&job->rng, opt.mdirs);
+			f->seq = job->mfseq++;
+			meta_path(newpath, job, f);
+			if( 0 > rename(path, newpath) ) errh_meta("rename", path);
+			break;
+		case MOP_STAT:
+			if( 0 > stat(path, &st) ) errh_meta("stat", path);
+			break;
+		case MOP_UNLINK:
+			if( 0 > unlink(path) ) errh_meta("unlink", path);
+			job->mf[i] = job->mf[--job->nmf];
+			break;
+	}
+	return res;
+}
+
+static inline int meta_pick(struct iojob * job)
+{
+	unsigned r;
+	int mop;
+
+	r = rng_below(&job->rng, opt.mopcum[MOP_N - 1]);
+	for( mop = 0; r >= opt.mopcum[mop]; mop++ )
+		;
+	return mop;
+}
+
+void * sub_metaworker(void * arg)
+{
+	struct iojob * job = (struct iojob *)arg;
+	char path[PATH_MAX];
+	unsigned long long i, deadline, t0, t1, bytes;
+	int mop;
+
+	job_place(job);
+	for( i = 0; i < opt.mfiles; i++ ){ /* the initial files, not measured */
+		mop = MOP_CREATE;
+		meta_op(job, &mop);
+	}
+	job_begin(job);
+	t1 = job->beginns;
+	deadline = job->beginns + opt.runtimens;
+	while( opt.runtimens ? t1 < deadline : job->doneios < job->totio ){
+		mop = meta_pick(job);
+		t0 = t1;
+		bytes = meta_op(job, &mop);
+		t1 = now_ns();
+		lathist_record(job->lat, t1 - t0);
+		lathist_record(&job->mopst[mop].lat, t1 - t0);
+		job->mopst[mop].ios++;
+		job->mopst[mop].bytes += bytes;
+		job->donebytes += bytes;
+		job->doneios++;
+	}
+	job_end(job);
+
+	for( i = 0; ! opt.mkeep && i < job->nmf; i++ ){
+		meta_path(path, job, &job->mf[i]);
+		if( 0 > unlink(path) ) errh_meta("unlink", path);
+	}
+	return NULL;
+}/* end of sub_metaworker */
+
+/*
+ * sub_meta
+ * 	the metadata phase: makes the directories, starts the jobs at the 
+ * 	same time, and prints the aggregate, per op and per job results
+ */
+void sub_meta(const struct phase * phase, FILE * out)
+{
+	struct iojob * job;
+	struct substat mopst[MOP_N];
+	char path[PATH_MAX];
+	unsigned long long nfiles;
+	struct jobsum js;
+	struct timeval starttime;
+	long w;
+	int status, c;
+	unsigned d;
+
+	if(opt.debug){fprintf(stdout,"\n sub_meta start: %u dirs, %d jobs\n", opt.mdirs, opt.njobs); 
+		fflush(stdout);}
+	for( d = 0; d < opt.mdirs; d++ ){
+		snprintf(path, sizeof(path), "%s/d%u", opt.fnames[0], d);
+		if( 0 > mkdir(path, 0755) && EEXIST != errno ) errh_meta("mkdir", path);
+	}
+	js.lat = (lathist_t *)malloc(sizeof(lathist_t));
+	errh_malloc(js.lat, "latency histogram");
+	lathist_init(js.lat);
+	for( c = 0; c < MOP_N; c++ ){
+		lathist_init(&mopst[c].lat);
+		mopst[c].ios = mopst[c].bytes = 0;
+	}
+
+	gettimeofday(&starttime, NULL);
+	status = meeting_init(&opt.startmeet, opt.njobs + 1);
+	errh_iogeneric("meeting_init", -status);
+	for(w = 0; w < opt.njobs; w++){
+		job = &opt.jobs[w];
+		job->phase = phase;
+		job->totio = opt.totio / opt.njobs + ( w < opt.totio % opt.njobs ? 1 : 0);
+		job->doneios = job->donebytes = 0;
+		job->finished = FALSE;
+		rng_seed(&job->rng, opt.seed + w);
+		job->mf = NULL;
+		job->nmf = job->mfcap = job->mfseq = 0;
+		job->lat = (lathist_t *)malloc(sizeof(lathist_t));
+		errh_malloc(job->lat, "latency histogram");
+		lathist_init(job->lat);
+		job->mopst = (struct substat *)malloc(MOP_N * sizeof(struct substat));
+		errh_malloc(job->mopst, "op statistics");
+		for( c = 0; c < MOP_N; c++ ){
+			lathist_init(&job->mopst[c].lat);
+			job->mopst[c].ios = job->mopst[c].bytes = 0;
+		}
+		status = pthread_create(&job->tid, NULL, sub_metaworker, job);
+		if( 0 != status ){
+			fprintf(stderr, "Error: cannot start job %ld: %s\n", w, strerror(status));
+			exit(1);
+		}
+	}
+	jobs_begin(&js, phase->type); /* the initial files are done */
+	nfiles = 0;
+	for(w = 0; w < opt.njobs; w++){
+		pthread_join(opt.jobs[w].tid, NULL);
+		jobsum_add(&js, &opt.jobs[w]);
+		for( c = 0; c < MOP_N; c++ ){
+			lathist_merge(&mopst[c].lat, &opt.jobs[w].mopst[c].lat);
+			mopst[c].ios += opt.jobs[w].mopst[c].ios;
+			mopst[c].bytes += opt.jobs[w].mopst[c].bytes;
+		}
+		nfiles += opt.jobs[w].nmf;
+	}
+	jobs_end(&js);
+	for( d = 0; ! opt.mkeep && d < opt.mdirs; d++ ){
+		snprintf(path, sizeof(path), "%s/d%u", opt.fnames[0], d);
+		if( 0 > rmdir(path) && ENOTEMPTY != errno ) errh_meta("rmdir", path);
+	}
+
+	fprintf(out, "{\"start\":%ld.%06ld, \"jobs\":%d, \"blocksize\":%lld, \"iocount\":%lld, \"seed\":%llu, ", 
+            starttime.tv_sec, starttime.tv_usec, opt.njobs, opt.mbl, opt.totio, opt.seed);
+	if( opt.runtimens )
+		fprintf(out, "\"runtime\":%f, ", (double)opt.runtimens / 1e9);
+	fprintf(out, "\"type\":\"%s\", \"dir\":\"%s\", \"dirs\":%u, \"files_per_job\":%llu, \"opmix\":{", 
+		phase->type, opt.fnames[0], opt.mdirs, opt.mfiles);
+	for( c = 0; c < MOP_N; c++ )
+		fprintf(out, "%s\"%s\":%u", c ? ", " : "", mopnames[c], 
+			opt.mopcum[c] - ( c ? opt.mopcum[c - 1] : 0 ));
+	fprintf(out, "}, \"files_left\":%llu, ", nfiles);
+	print_stats(out, (double)(js.endns - js.beginns) / 1e9, js.ios, js.bytes, js.lat);
+	print_cost(out, &js);
+	fprintf(out, ", \"ops\":[");
+	for( c = 0; c < MOP_N; c++ ){
+		fprintf(out, "%s{\"op\":\"%s\", ", c ? ", " : "", mopnames[c]);
+		print_stats(out, (double)(js.endns - js.beginns) / 1e9, mopst[c].ios, mopst[c].bytes, &mopst[c].lat);
+		fprintf(out, "}");
+	}
+	fprintf(out, "]");
+	print_threads(out);
+	fprintf(out, "}");
+	fflush(out);
+
+	for(w = 0; w < opt.njobs; w++){
+		free(opt.jobs[w].lat);
+		free(opt.jobs[w].mopst);
+		free(opt.jobs[w].mf);
+	}
+	free(js.lat);
+	opt.phaseno++;
+	if(opt.debug){fprintf(stdout," sub_meta end "); fflush(stdout);}
+}/* end of sub_meta */
+
+/*
+ * -f[op=weight,...][,files=#][,dirs=#][,keep]  the metadata workload, 
+ * returns FALSE on error
+ */
+int parse_meta(const char * arg)
+{
+	static const unsigned defmix[MOP_N] = { 20, 20, 10, 10, 30, 10 };
+	unsigned weight[MOP_N];
+	int mop, mixset = FALSE;
+	size_t len, n;
+	char * end;
+
+	opt.meta = TRUE;
+	memset(weight, 0, sizeof(weight));
+	while( '\0' != *arg ){
+		len = strcspn(arg, ",");
+		if( 4 == len && 0 == strncmp(arg, "keep", 4) ){
+			opt.mkeep = TRUE;
+		}else if( 0 == strncmp(arg, "files=", 6) ){
+			opt.mfiles = strtoull(arg + 6, &end, 10);
+			if( end == arg + 6 || end != arg + len ) return FALSE;
+		}else if( 0 == strncmp(arg, "dirs=", 5) ){
+			opt.mdirs = strtoul(arg + 5, &end, 10);
+			if( 0 == opt.mdirs || end != arg + len ) return FALSE;
+		}else{
+			for( mop = 0; mop < MOP_N; mop++ ){
+				n = strlen(mopnames[mop]);
+				if( 0 == strncmp(arg, mopnames[mop], n) && '=' == arg[n] ) break;
+			}
+			if( MOP_N == mop ) return FALSE;
+			weight[mop] = strtoul(arg + n + 1, &end, 10);
+			if( end == arg + n + 1 || end != arg + len ) return FALSE;
+			mixset = TRUE;
+		}
+		arg += len;
+		if( ',' == *arg ) arg++;
+	}
+	for( mop = 0; mop < MOP_N; mop++ )
+		opt.mopcum[mop] = ( mop ? opt.mopcum[mop - 1] : 0 ) + ( mixset ? weight[mop] : defmix[mop] );
+	return 0 < opt.mopcum[MOP_N - 1];
+}
+
+/*
+ * one phase: a single run, a sweep or the metadata workload
+ */
+void sub_phase(const struct phase * phase, FILE * out)
+{
+	if( phase->meta )
+		sub_meta(phase, out);
+	else if( opt.nsweepbs )
+		sub_sweep(phase, out);
+	else
+		sub_doio(phase, out, NULL);
+}
+
+/*
+ * steady_state
+ * 	the n values of y are steady if their range is within opt.pctol
+ * 	percent and the excursion of their linear fit within opt.pctol/2
+ * 	percent of their average (SNIA PTS)
+ */
+int steady_state(const double * y, int n, double * avg, double * rangepct, double * slopepct)
+{
+	double min, max, sx = 0.0, sy = 0.0, sxy = 0.0, sxx = 0.0, slope;
+	int i;
+
+	min = max = y[0];
+	for( i = 0; i < n; i++ ){
+		if( y[i] < min ) min = y[i];
+		if( y[i] > max ) max = y[i];
+		sx += i;
+		sy += y[i];
+		sxy += i * y[i];
+		sxx += (double)i * i;
+	}
+	*avg = sy / n;
+	slope = ( n * sxy - sx * sy ) / ( n * sxx - sx * sx );
+	*rangepct = *avg > 0.0 ? 100.0 * ( max - min ) / *avg : 0.0;
+	*slopepct = *avg > 0.0 ? 100.0 * fabs(slope) * ( n - 1 ) / *avg : 0.0;
+	return *avg > 0.0 && *rangepct <= opt.pctol && *slopepct <= opt.pctol / 2.0;
+}
+
+/*
+ * sub_precondition
+ * 	opt.pcfills sequential writes over the whole target, then uniform 
+ * 	random write rounds until the iops of the last opt.pcwindow rounds are 
+ * 	steady. The progress goes to stdout as json lines, the results of 
+ * 	the runs are not printed. Returns TRUE if the steady state was reached.
+ * 	The phases are marked precond: sub_doio() leaves out the options of 
+ * 	the measured phases (rate, flush, discard, bssplit, align, streams, 
+ * 	distribution, io log). The data pattern stays: the target can be 
+ * 	verified after it, and a compressing device gets the same data.
+ */
+int sub_precondition(void)
+{
+	static const struct phase fill = { .type = "precond_fill", .readpct = 0, .precond = TRUE };
+	static const struct phase rounds = { .type = "precond_steady", .readpct = 0, .rndwrite = TRUE, 
+		.precond = TRUE };
+	struct runsum sum;
+	double * iops;
+	double avg, rangepct, slopepct;
+	FILE * devnull;
+	int pass, round, steady;
+
+	devnull = fopen("/dev/null", "w");
+	errh_malloc(devnull, "/dev/null stream");
+	iops = (double *)calloc(opt.pcmax, sizeof(double));
+	errh_malloc(iops, "steady state rounds");
+
+	for( pass = 1; pass <= opt.pcfills; pass++ ){
+		sub_doio(&fill, devnull, &sum);
+		printf("{\"precondition\":\"fill\", \"pass\":%d, \"elapsed\":%f, \"bytes\":%llu, \"byteps\":%f}\n",
+			pass, sum.elapsed, sum.bytes, sum.elapsed > 0.0 ? sum.bytes / sum.elapsed : 0.0);
+		fflush(stdout);
+	}
+
+	for( steady = FALSE, round = 0; round < opt.pcmax && ! steady; round++ ){
+		sub_doio(&rounds, devnull, &sum);
+		iops[round] = sum.elapsed > 0.0 ? sum.ios / sum.elapsed : 0.0;
+		printf("{\"precondition\":\"steady\", \"round\":%d, \"iops\":%f, \"byteps\":%f, \"mean_us\":%.3f",
+			round + 1, iops[round], sum.elapsed > 0.0 ? sum.bytes / sum.elapsed : 0.0, sum.meanns / 1000.0);
+		if( round + 1 >= opt.pcwindow ){
+			steady = steady_state(iops + round + 1 - opt.pcwindow, opt.pcwindow, &avg, &rangepct, &slopepct);
+			printf(", \"window_iops\":%f, \"range_pct\":%.2f, \"slope_pct\":%.2f", avg, rangepct, slopepct);
+		}
+		printf(", \"steady\":%s}\n", steady ? "true" : "false");
+		fflush(stdout);
+	}
+	if( ! steady ){
+		printf("{\"precondition\":\"failed\", \"rounds\":%d}\n", round);
+		fprintf(stderr, "Error: no steady state in %d rounds (window %d, tolerance %g%%)\n",
+			round, opt.pcwindow, opt.pctol);
+	}
+
+	fclose(devnull);
+	free(iops);
+	return steady;
+}
+
+/*
+ * sub_zones
+ * 	-z: the sequential write zones of the target into opt.zones
+ */
+void sub_zones(void)
+{
+	zone_t * all;
+	struct stat st;
+	char path[64];
+	FILE * f;
+	unsigned n, maxopen;
+	long got, i;
+	int fd;
+
+	fd = open(opt.fnames[0], O_RDONLY);
+	if( 0 > fd ){
+		fprintf(stderr, "Error opening '%s'", opt.fnames[0]);
 		perror(" ");
-		exit(1) ;
+		exit(1);
+	}
+	n = zoned_count(fd);
+	if( 0 == n ){
+		fprintf(stderr, "Error: '%s' is not a zoned block device\n", opt.fnames[0]);
+		exit(1);
+	}
+	all = (zone_t *)malloc(n * sizeof(zone_t));
+	errh_malloc(all, "array of zones");
+	got = zoned_report(fd, all, n);
+	if( 0 > got ){
+		fprintf(stderr, "Error: cannot report the zones of '%s': %s\n", opt.fnames[0], strerror(-got));
+		exit(1);
+	}
+	opt.zones = (struct zone *)calloc(got, sizeof(struct zone));
+	errh_malloc(opt.zones, "array of zones");
+	for( opt.nzones = i = 0; i < got; i++ ) /* the conventional ones are not used */
+		if( zoned_seqwritable(&all[i]) )
+			opt.zones[opt.nzones++].z = all[i];
+	if( 0 == opt.nzones ){
+		fprintf(stderr, "Error: '%s' has no writable sequential zone\n", opt.fnames[0]);
+		exit(1);
+	}
+	/* the open zones of the device are limited, 0: no limit */
+	if( 0 == fstat(fd, &st) ){
+		snprintf(path, sizeof(path), "/sys/dev/block/%u:%u/queue/max_open_zones", 
+			major(st.st_rdev), minor(st.st_rdev));
+		f = fopen(path, "r");
+		if( NULL != f && 1 == fscanf(f, "%u", &maxopen) && maxopen &&
+		    maxopen < opt.njobs * ( opt.zopen && opt.zopen < opt.threadcnt ? opt.zopen : opt.threadcnt ) )
+			fprintf(stderr, "Warn: more open zones (-j x -z) than the %u of the device\n", maxopen);
+		if( NULL != f ) fclose(f);
 	}
+	if(opt.debug){printf(" zones: %u, sequential: %ld, size: %llu\n", n, opt.nzones, 
+		(unsigned long long)opt.zones[0].z.len);fflush(stdout);}
+	free(all);
+	close(fd);
+}
 
-	opt.buff=(char **)malloc(opt.threadcnt*sizeof(char *) );
-	for( i=0 ; i < opt.threadcnt ; i ++ ){
-		totbuff = (char *)malloc(roundup4k(opt.mbl)+4096+sizeof(int));
-		errh_malloc(totbuff, "one of opt.buff");
-		opt.buff[i] = (char *)roundup4k((unsigned long long)totbuff);
+/*
+ * sub_tracescan
+ * 	one pass over the trace before the replay: number of the records, 
+ * 	start time, the largest io (for the buffers), and the target size
+ */
+unsigned long long sub_tracescan(void)
+{
+	trace_t tr;
+	trace_rec_t rec;
+	unsigned long long n = 0;
+	int status;
 
-		if(opt.debug) printf("totbuff=%p buff[%lld]=%p\n",totbuff,i, opt.buff[i]);
+	opt.filesize = gettargetsize();
+	status = trace_open(&tr, opt.tracefile);
+	if( status ){
+		fprintf(stderr, "Error: cannot open the trace '%s': %s\n", opt.tracefile, strerror(-status));
+		exit(1);
+	}
+	opt.maxreclen = 0;
+	while( 0 < (status = trace_next(&tr, &rec)) ){
+		if( 0 == n || rec.ns < opt.tracestart ) opt.tracestart = rec.ns;
+		if( rec.len > opt.maxreclen ) opt.maxreclen = rec.len;
+		n++;
+	}
+	trace_close(&tr);
+	if( 0 > status ){
+		fprintf(stderr, "Error: invalid trace record in '%s' (line %lu)\n", opt.tracefile, tr.line);
+		exit(1);
+	}
+	if( 0 == n ){
+		fprintf(stderr, "Error: no io in the trace '%s'\n", opt.tracefile);
+		exit(1);
+	}
+	if( opt.maxreclen > opt.filesize ){
+		fprintf(stderr, "Error: the trace has a larger io (%llu) than the target\n", opt.maxreclen);
+		exit(1);
+	}
+	if(opt.debug){printf(" trace: %llu records, the largest is %llu bytes\n", n, opt.maxreclen);fflush(stdout);}
+	return n;
+}
 
-		if( opt.uncompressable ){
-			status=read(opt.rndfh, opt.buff[i], roundup4k(opt.mbl) );
-			if( 0 == status ) 
-				errh_iogeneric("read( randomfile )", errno);
-		} else{
-			for(j = 0; j<=((roundup4k(opt.mbl)) / sizeof(int)); j++)
-	       			((unsigned int *)opt.buff[i])[j]= MAGIC;
-		} /* end if uncompressable */
+void puthelp(void)
+{
+	fprintf(stderr,"fillone version %s copyright by Maulis Adam 2024, using AGPL v3 or newer\n\n", VERS); 
+	fprintf(stderr,"Usage: fillone [options] filename[,filename...] blocksize datasize\n");
+	fprintf(stderr,"   more targets: one workload over all of them, in the same time window\n");
+	fprintf(stderr,"   -l lazy: datasize will be rounded up of multiple of blocksize\n");
+	fprintf(stderr,"   -p1 sequential write (overwrites data, extends file to datasize) (default test phase)\n");
+	fprintf(stderr,"       more phases (like -p1234) run in the given order, the output is a json array\n");
+	fprintf(stderr,"   -p2 random write (overwrites data, does not extend file)\n");
+	fprintf(stderr,"   -p3 sequential read\n");
+	fprintf(stderr,"   -p4 random read\n");
+	fprintf(stderr,"   -p5 mixed read/write in one io context (see -m)\n");
+	fprintf(stderr,"   -m#[,seqread][,seqwrite] mixed phase with # percent of reads (random by default);\n");
+	fprintf(stderr,"       without -p it selects the mixed phase only\n");
+	fprintf(stderr,"   -B<list> sweep: blocksizes, like 4k,64k or 512-1m (doubling); the blocksize\n");
+	fprintf(stderr,"       parameter is ignored\n");
+	fprintf(stderr,"   -Q<list> sweep: threadcounts, like 1-256 (doubling) (default: -t)\n");
+	fprintf(stderr,"       every point runs for -T seconds (default 10), the output is a matrix\n");
+	fprintf(stderr,"       with the knee point (latency rises faster than the throughput) per blocksize\n");
+	fprintf(stderr,"   -k<p#|mean> sweep: the latency of the knee point, a percentile (default p99, the\n");
+	fprintf(stderr,"       tail of the bursty devices) or the mean\n");
+	fprintf(stderr,"   -N#[,rnd] sequential phases: # streams per job, evenly spaced in the slice of the\n");
+	fprintf(stderr,"       job (rnd: from random offsets), they take turns; per stream stats in the output\n");
+	fprintf(stderr,"   -f[op=weight,...][,files=#][,dirs=#][,keep] metadata workload: the target is a\n");
+	fprintf(stderr,"       directory, the jobs create, write (append blocksize, up to 16 blocks, then from\n");
+	fprintf(stderr,"       the start again), fsync, rename, stat and unlink small files in its dirs (16)\n");
+	fprintf(stderr,"       subdirectories, like -fcreate=30,write=30,fsync=30,unlink=10 (default\n");
+	fprintf(stderr,"       20,20,10,10,30,10). Every job creates files (256) before the start, iocount is\n");
+	fprintf(stderr,"       the number of the ops, per op stats in the output; all is removed at the end,\n");
+	fprintf(stderr,"       except with keep. -t, -r and -e are ignored\n");
+	fprintf(stderr,"   -z[#][,reset] zoned block device (ZNS, SMR), needs -r: every write goes to the write\n");
+	fprintf(stderr,"       pointer of an open zone (# per job, default -t), one write in flight per zone, so\n");
+	fprintf(stderr,"       # < -t lowers the threadcount to # (also in the random write phases, and for\n");
+	fprintf(stderr,"       the reads of the mixed phase), the jobs share the sequential zones round\n");
+	fprintf(stderr,"       robin; reset: the full zones are reset and reused (needed by -T); per zone\n");
+	fprintf(stderr,"       throughput in the output\n");
+	fprintf(stderr,"   -a[4k|2m|1g][,node=#|dev] the buffers of all the jobs in one arena of 4 KiB, 2 MiB\n");
+	fprintf(stderr,"       or 1 GiB pages (hugetlb, see vm.nr_hugepages), bound to numa node # or to the\n");
+	fprintf(stderr,"       node of the device (sysfs); the placement of its pages is in the output\n");
+	fprintf(stderr,"   -D drop the page cache between the phases and the sweep points (needs root)\n");
+	fprintf(stderr,"   -S# sleep # seconds between the phases and the sweep points\n");
+	fprintf(stderr,"   -b<size/weight,...> blocksize distribution (bssplit), like 4k/60,64k/30,1m/10,\n");
+	fprintf(stderr,"       per size stats in the output; the blocksize parameter is ignored\n");
+	fprintf(stderr,"   -A# alignment of the random offsets (default: the blocksize; 4k with -b), a multiple\n");
+	fprintf(stderr,"       of 4k with -v, -u, -C and -X (their data is per 4KiB block)\n");
+	fprintf(stderr,"   -P<trace>[,fast][,speed=#] replay a trace (csv or binary, see blk2trace): timed\n");
+	fprintf(stderr,"       on its own timeline (# times faster), or fast: as fast as possible with -t depth;\n");
+	fprintf(stderr,"       the blocksize is the stripe unit only, datasize is ignored\n");
+	fprintf(stderr,"   -M<rr|rnd> more targets: striped with the blocksize as stripe unit (rr, default),\n");
+	fprintf(stderr,"       or random target per io (rnd); the smallest target limits the random tests\n");
+	fprintf(stderr,"   -Fn#|b<size>[,...][,fsync] flush every # writes and/or every <size> written bytes\n");
+	fprintf(stderr,"       (async fdatasync, or fsync), like -Fn64 or -Fb1m,fsync; own stats in the output\n");
+	fprintf(stderr,"   -K#[,size] discard every # ios (default size: the blocksize), punch hole on files,\n");
+	fprintf(stderr,"       BLKDISCARD on block devices (done synchronously, except punch hole on uring)\n");
+	fprintf(stderr,"       -F and -K work in the phases with writes, on top of the iocount\n");
+	fprintf(stderr,"   -W[#][,round=#][,window=#][,tol=#][,max=#] precondition before the phases: # (default 2)\n");
+	fprintf(stderr,"       sequential fills of the whole target, then uniform random write rounds of round\n");
+	fprintf(stderr,"       seconds (60) until the iops of the last window (5) rounds are within tol%% (20) of\n");
+	fprintf(stderr,"       their average, the slope within tol/2%%; at most max (25) rounds, or exit code 3.\n");
+	fprintf(stderr,"       The progress is printed as json lines, with the blocksize and -t, -j; -R, -F,\n");
+	fprintf(stderr,"       -K, -b, -A, -N, -d and -L are for the measured phases only\n");
+	fprintf(stderr,"   -r raw: uses O_DIRECT for open (disables local cache)\n");
+	fprintf(stderr,"   -u uncompressable and non-deduplicable pattern (the default is the 0xDEADBEEF pattern)\n");
+	fprintf(stderr,"   -C# generated pattern with # compression ratio (like 2 for 2:1), per 4KiB block\n");
+	fprintf(stderr,"   -X# generated pattern with # dedup ratio (over the datasize), per 4KiB block\n");
+	fprintf(stderr,"       (-C and -X override -u, the data depends on the seed)\n");
+	fprintf(stderr,"   -v[file] verify the reads per 4KiB block: the -u stamps, the -C/-X data (same seed!)\n");
+	fprintf(stderr,"       or the 0xDEADBEEF pattern; the first bad block is dumped into file.\n");
+	fprintf(stderr,"       The exit code is 2 if there was a bad block.\n");
+	fprintf(stderr,"   -t# thread count (# means integer): outstanding ios of each job\n");
+	fprintf(stderr,"   -j#[,shared] jobs: worker threads, each with own io context, buffers and\n");
+	fprintf(stderr,"       slice of the file (shared: the random tests use the whole file in every job)\n");
+	fprintf(stderr,"   -c[cpulist] pin the jobs to cpus, like 0,2,4-7 (default: the available cpus)\n");
+	fprintf(stderr,"   -T# time based run: stops after # seconds, wraps around in datasize (or in the file)\n");
+	fprintf(stderr,"   -i# interval report in every # milliseconds (json lines before the result)\n");
+	fprintf(stderr,"   -R#[,poisson] open loop: # ios/sec (all jobs together) on a fixed timeline,\n");
+	fprintf(stderr,"       the latency counts from the scheduled time (poisson: random arrivals)\n");
+	fprintf(stderr,"   -s# seed of the random offsets (default: read from the random pool)\n");
+	fprintf(stderr,"   -d<dist> random offset distribution: uniform (default), zipf[:theta] (default theta 0.99),\n");
+	fprintf(stderr,"       hot:x:y (x%% of the ios goes to the first y%% of the device)\n");
+	fprintf(stderr,"   -e<engine>[,flags] io engine: aio (default), uring, mmap or psync\n");
+	fprintf(stderr,"       uring flags: regbuf (registered buffers), regfile (registered file),\n");
+	fprintf(stderr,"       sqpoll (kernel thread polls the submissions, no syscall to submit),\n");
+	fprintf(stderr,"       iopoll (polled block io, no interrupts, needs -r, implies -y)\n");
+	fprintf(stderr,"       mmap: the jobs copy from/to shared mappings of the targets (page faults do\n");
+	fprintf(stderr,"       the io, msync is the flush), flags: populate (MAP_POPULATE), seq, rnd or\n");
+	fprintf(stderr,"       willneed (madvise)\n");
+	fprintf(stderr,"       psync: pread/pwrite, flags: seq, rnd, willneed or noreuse (posix_fadvise),\n");
+	fprintf(stderr,"       dontneed (drop every io from the cache), ra=<size> (readahead after the reads)\n");
+	fprintf(stderr,"       mmap and psync are synchronous: threadcount 1, more jobs with -j. The page\n");
+	fprintf(stderr,"       faults of the jobs are in the output (with the other engines with -H)\n");
+	fprintf(stderr,"   -y busy polling of the completions (aio: the ring in userspace, no syscall), costs\n");
+	fprintf(stderr,"       a cpu per job: see cpu_pct in the output (also with -H)\n");
+	fprintf(stderr,"   -q[submit=#][,complete=#][,low=#] batching: at most # ios per submit call (default:\n");
+	fprintf(stderr,"       all the ready ones), the reap waits for # completions (default: 1), the completed\n");
+	fprintf(stderr,"       slots are refilled only when # or less ios are in flight (default: at once).\n");
+	fprintf(stderr,"       The open loop (-R, replay) only splits the submits. The syscalls per io are\n");
+	fprintf(stderr,"       in the output (without -q with -H)\n");
+	fprintf(stderr,"   -H[event,...] the cost of the run in the output: cpu time, rusage and the perf counters\n");
+	fprintf(stderr,"       of the jobs, default: cycles,instructions,cache-misses; others: cache-references\n");
+	fprintf(stderr,"       branch-misses page-faults cpu-migrations\n");
+	fprintf(stderr,"   -L<file> per io binary log (offset, size, times, result) by a writer thread, for\n");
+	fprintf(stderr,"       iologstat; better on an other device. Full rings drop records (see the output)\n\n");
+	fprintf(stderr,"Environment variables:\n");
+    fprintf(stderr,"    DEBUG  # if not set, there is no debug messages\n"); 
+    fprintf(stderr,"    RANDOMPOOL # if not set use %s\n", RANDOMPOOL);
+}
+
+int main(int argc, char* argv[])
+{
+	int optarg;
+	int lazy = 0;
+	int seedset;
+	int ismixed=0;
+	const struct phase * runlist[5]; /* the selected phases in order */
+	int nrun = 0;
+	int phaseset = FALSE;
+	struct phase mixphase = { .type = "mixed" }; /* the rest after the options */
+	char * ca;
+	char * end;
+	char * results;
+	size_t resultslen;
+	FILE * out;
+	long long i;
+	unsigned long long maxbs = 0, w;
+	ssize_t status;
+	struct stat st;
+	int fd, lbs;
+	
+	opt.threadcnt = 1;
+	opt.njobs = 1;
+	opt.sharedrnd = FALSE;
+	opt.ncpus = 0;
+	opt.runtimens = 0;
+	opt.intervalms = 0;
+	opt.rate = 0.0;
+	opt.poisson = FALSE;
+	opt.poll = opt.iopoll = FALSE;
+	opt.nperfev = 0;
+	opt.iologfile = NULL;
+	opt.phaseno = 0;
+	opt.precond = FALSE;
+	opt.nstreams = 0;
+	opt.streamrnd = FALSE;
+	opt.meta = opt.mkeep = FALSE;
+	opt.mdirs = 16;
+	opt.mfiles = 256;
+	opt.zoned = opt.zreset = FALSE;
+	opt.zopen = 0;
+	opt.zones = NULL;
+	opt.nzones = 0;
+	opt.arena = FALSE;
+	opt.arenanode = -1;
+	opt.batching = FALSE;
+	opt.batchsub = 0;
+	opt.batchcomp = 1;
+	opt.iolow = -1;
+	opt.devnode = -1;
+	opt.pcfills = 2;
+	opt.pcroundns = 60000000000ULL;
+	opt.pcwindow = 5;
+	opt.pctol = 20.0;
+	opt.pcmax = 25;
+	opt.readpct = -1;
+	opt.dropcaches = FALSE;
+	opt.phasesleep = 0;
+	opt.nsweepbs = opt.nsweepqd = 0;
+	opt.kneepct = 99.0;
+	opt.tracefile = NULL;
+	opt.replayspeed = 1.0;
+	opt.rawmode = 0;
+	opt.uncompressable = FALSE;
+	opt.compress = opt.dedup = 0.0;
+	opt.verify = opt.dumped = FALSE;
+	opt.targetrnd = FALSE;
+	opt.dumpfile = NULL;
+	opt.nbss = 0;
+	opt.align = 0;
+	opt.badblocks = 0;
+	opt.flushn = opt.flushbytes = 0;
+	opt.flushfull = FALSE;
+	opt.discardn = opt.discardlen = 0;
+	opt.engine = &engines[0];
+	opt.dist = DIST_UNIFORM;
+	seedset = FALSE;
+
+	if( NULL != getenv("DEBUG") ){
+		opt.debug = atoi(getenv("DEBUG"));
+		if( 0 == opt.debug ) opt.debug = 1;
+        printf("Debug messages are enabled.\n");fflush(stdout);
+	} else {
+		opt.debug = 0;
+	}
+
+    if( NULL != getenv("RANDOMPOOL") ){
+        opt.randompool = getenv("RANDOMPOOL");
+    }else{
+        opt.randompool = RANDOMPOOL;
+    }
+    if(opt.debug){printf(" randompool=%s\n", opt.randompool);fflush(stdout);}
+
+	for(optarg=1;  optarg < argc && argv[optarg][0] == '-'; optarg++ ){
+		if(opt.debug){printf(" processing opt%d:%s\n",optarg,argv[optarg]);fflush(stdout);}
+		switch( argv[optarg][1] ){
+			case 'l': lazy = 1;
+				break;
+			case 'r': opt.rawmode = O_DIRECT;
+				break;
+			case 'u': opt.uncompressable = 1;
+				break;
+			case 'P': opt.tracefile = strtok(argv[optarg]+2, ",");
+				  for( ca = strtok(NULL, ","); NULL != ca; ca = strtok(NULL, ",") ){
+					if( 0 == strcmp(ca, "fast") )
+						opt.replayspeed = 0.0;
+					else if( 0 == strncmp(ca, "speed=", 6) && 0.0 < atof(ca + 6) )
+						opt.replayspeed = atof(ca + 6);
+					else{
+						fprintf(stderr,"Invalid replay option: %s\n", ca);
+						return 1;
+					}
+				  }
+				  if( NULL == opt.tracefile ){
+					fprintf(stderr,"Missing trace file: %s\n", argv[optarg]);
+					return 1;
+				  }
+				break;
+			case 'b': if( ! parse_bssplit(argv[optarg]+2) ){
+					fprintf(stderr,"Invalid bssplit: %s\n", argv[optarg]+2);
+					return 1;
+				  }
+				break;
+			case 'A': opt.align = parse_size(argv[optarg]+2, &ca);
+				if( 0 == opt.align || '\0' != *ca ){
+					fprintf(stderr,"Invalid alignment: %s\n", argv[optarg]+2);
+					return 1;
+				}
+				break;
+			case 'M': if( 0 == strcmp(argv[optarg]+2, "rnd") )
+					opt.targetrnd = TRUE;
+				  else if( 0 == strcmp(argv[optarg]+2, "rr") )
+					opt.targetrnd = FALSE;
+				  else{
+					fprintf(stderr,"Invalid target mode: %s\n", argv[optarg]+2);
+					return 1;
+				  }
+				break;
+			case 'F': for( ca = strtok(argv[optarg]+2, ","); NULL != ca; ca = strtok(NULL, ",") ){
+					if( 'n' == *ca )
+						opt.flushn = strtoull(ca + 1, &end, 10);
+					else if( 'b' == *ca )
+						opt.flushbytes = parse_size(ca + 1, &end);
+					else if( 0 == strcmp(ca, "fsync") ){
+						opt.flushfull = TRUE;
+						continue;
+					}else
+						end = ca;
+					if( end == ca + 1 || '\0' != *end ){
+						fprintf(stderr,"Invalid flush option: %s\n", ca);
+						return 1;
+					}
+				  }
+				  if( 0 == opt.flushn && 0 == opt.flushbytes ){
+					fprintf(stderr,"Missing flush interval: %s\n", argv[optarg]);
+					return 1;
+				  }
+				break;
+			case 'K': opt.discardn = strtoull(argv[optarg]+2, &end, 10);
+				  if( ',' == *end ){
+					ca = end + 1;
+					opt.discardlen = parse_size(ca, &end);
+					if( end == ca || 0 == opt.discardlen ) end = ca;
+				  }
+				  if( 0 == opt.discardn || '\0' != *end ){
+					fprintf(stderr,"Invalid discard option: %s\n", argv[optarg]+2);
+					return 1;
+				  }
+				break;
+			case 'v': opt.verify = TRUE;
+				  if( '\0' != argv[optarg][2] ) opt.dumpfile = argv[optarg]+2;
+				break;
+			case 'C':opt.compress = atof(argv[optarg]+2);
+				if( 1.0 > opt.compress ){
+					fprintf(stderr,"Invalid compression ratio (at least 1): %s\n", argv[optarg]+2);
+					return 1;
+				}
+				break;
+			case 'X':opt.dedup = atof(argv[optarg]+2);
+				if( 1.0 > opt.dedup ){
+					fprintf(stderr,"Invalid dedup ratio (at least 1): %s\n", argv[optarg]+2);
+					return 1;
+				}
+				break;
+			case 'p': for( ca = argv[optarg]+2; *ca; ca++ ){
+					if( *ca < '1' || *ca > '5' || 
+					    NULL != strchr(ca + 1, *ca) ) /* the last one counts */
+						continue;
+					if( '5' == *ca ) ismixed = 1;
+					runlist[nrun++] = '5' == *ca ? &mixphase : &phases[*ca - '1'];
+				  }
+				  phaseset = TRUE;
+				break;
+			case 'D': opt.dropcaches = TRUE;
+				break;
+			case 'S': opt.phasesleep = atoi(argv[optarg]+2);
+				break;
+			case 'B': opt.nsweepbs = parse_sweeplist(argv[optarg]+2, opt.sweepbs);
+				if( 0 == opt.nsweepbs ){
+					fprintf(stderr,"Invalid blocksize list: %s\n", argv[optarg]+2);
+					return 1;
+				}
+				break;
+			case 'Q': opt.nsweepqd = parse_sweeplist(argv[optarg]+2, opt.sweepqd);
+				if( 0 == opt.nsweepqd ){
+					fprintf(stderr,"Invalid threadcount list: %s\n", argv[optarg]+2);
+					return 1;
+				}
+				break;
+			case 'k': if( 0 == strcmp(argv[optarg]+2, "mean") ){
+					opt.kneepct = 0.0;
+				  }else if( 'p' == argv[optarg][2] ){
+					opt.kneepct = strtod(argv[optarg]+3, &end);
+					if( end == argv[optarg]+3 || '\0' != *end || 0.0 >= opt.kneepct || 100.0 < opt.kneepct ){
+						fprintf(stderr,"Invalid knee percentile: %s\n", argv[optarg]+2);
+						return 1;
+					}
+				  }else{
+					fprintf(stderr,"Invalid knee latency: %s\n", argv[optarg]+2);
+					return 1;
+				  }
+				break;
+			case 'm':opt.readpct = atoi(argv[optarg]+2);
+				  opt.mixseqread = NULL != strstr(argv[optarg], ",seqread");
+				  opt.mixseqwrite = NULL != strstr(argv[optarg], ",seqwrite");
+				if( 0 > opt.readpct || 100 < opt.readpct ){
+					fprintf(stderr,"Invalid read percent: %s\n", argv[optarg]+2);
+					return 1;
+				}
+				break;
+			case 't':opt.threadcnt = atoi(argv[optarg]+2);
+				break;
+			case 'j':opt.njobs = atoi(argv[optarg]+2);
+				  opt.sharedrnd = NULL != strstr(argv[optarg], ",shared");
+				break;
+			case 'c': if( ! parse_cpus(argv[optarg]+2) ){
+					fprintf(stderr,"Invalid cpu list: %s\n", argv[optarg]+2);
+					puthelp();
+					return 1;
+				  }
+				break;
+			case 'T':opt.runtimens = (unsigned long long)(atof(argv[optarg]+2) * 1e9);
+				break;
+			case 'i':opt.intervalms = atol(argv[optarg]+2);
+				if( 0 >= opt.intervalms ){
+					fprintf(stderr,"Invalid interval: %s\n", argv[optarg]+2);
+					return 1;
+				}
+				break;
+			case 'R':opt.rate = atof(argv[optarg]+2);
+				  opt.poisson = NULL != strstr(argv[optarg], ",poisson");
+				if( 0.0 >= opt.rate ){
+					fprintf(stderr,"Invalid rate: %s\n", argv[optarg]+2);
+					return 1;
+				}
+				break;
+			case 's': opt.seed = strtoull(argv[optarg]+2, NULL, 0);
+				  seedset = TRUE;
+				break;
+			case 'd': if( ! parse_dist(argv[optarg]+2) ){
+					fprintf(stderr,"Invalid distribution: %s\n", argv[optarg]+2);
+					puthelp();
+					return 1;
+				  }
+				break;
+			case 'y': opt.poll = TRUE;
+				break;
+			case 'N': opt.nstreams = atoi(argv[optarg]+2);
+				  opt.streamrnd = NULL != strstr(argv[optarg], ",rnd");
+				if( 1 > opt.nstreams ){
+					fprintf(stderr,"Invalid number of streams: %s\n", argv[optarg]+2);
+					return 1;
+				}
+				break;
+			case 'f': if( ! parse_meta(argv[optarg]+2) ){
+					fprintf(stderr,"Invalid metadata workload: %s\n", argv[optarg]+2);
+					puthelp();
+					return 1;
+				  }
+				break;
+			case 'q': if( ! parse_batch(argv[optarg]+2) ){
+					fprintf(stderr,"Invalid batching: %s\n", argv[optarg]+2);
+					puthelp();
+					return 1;
+				  }
+				break;
+			case 'a': opt.arena = TRUE;
+				  ca = argv[optarg]+2;
+				  if( 0 == strncmp(ca, "2m", 2) ) opt.arenapage = 1UL << 21;
+				  else if( 0 == strncmp(ca, "1g", 2) ) opt.arenapage = 1UL << 30;
+				  else if( 0 == strncmp(ca, "4k", 2) || '\0' == *ca || ',' == *ca ) opt.arenapage = 4096;
+				  else{
+					fprintf(stderr,"Invalid page size of the arena: %s\n", ca);
+					return 1;
+				  }
+				  ca = strstr(ca, ",node=");
+				  if( NULL != ca ){
+					opt.arenanode = 0 == strcmp(ca + 6, "dev") ? -2 : (int)strtol(ca + 6, &end, 10);
+					if( -2 != opt.arenanode && ( end == ca + 6 || '\0' != *end || 
+					    0 > opt.arenanode || ARENA_MAXNODES <= opt.arenanode ) ){
+						fprintf(stderr,"Invalid numa node: %s\n", ca + 6);
+						return 1;
+					}
+				  }
+				break;
+			case 'z': opt.zoned = TRUE;
+				  opt.zopen = atoi(argv[optarg]+2);
+				  opt.zreset = NULL != strstr(argv[optarg], ",reset");
+				if( 0 > opt.zopen ){
+					fprintf(stderr,"Invalid number of open zones: %s\n", argv[optarg]+2);
+					return 1;
+				}
+				break;
+			case 'W': opt.precond = TRUE;
+				  ca = argv[optarg]+2;
+				  if( '0' <= *ca && '9' >= *ca ) opt.pcfills = atoi(ca);
+				  for( ca = strchr(ca, ','); NULL != ca; ca = strchr(ca + 1, ',') ){
+					if( 0 == strncmp(ca, ",round=", 7) )
+						opt.pcroundns = (unsigned long long)(atof(ca + 7) * 1e9);
+					else if( 0 == strncmp(ca, ",window=", 8) )
+						opt.pcwindow = atoi(ca + 8);
+					else if( 0 == strncmp(ca, ",tol=", 5) )
+						opt.pctol = atof(ca + 5);
+					else if( 0 == strncmp(ca, ",max=", 5) )
+						opt.pcmax = atoi(ca + 5);
+					else
+						break;
+				  }
+				  if( NULL != ca || 0 > opt.pcfills || 0 == opt.pcroundns || 
+				      2 > opt.pcwindow || 0.0 >= opt.pctol || opt.pcmax < opt.pcwindow ){
+					fprintf(stderr,"Invalid preconditioning: %s\n", argv[optarg]+2);
+					return 1;
+				  }
+				break;
+			case 'L': opt.iologfile = argv[optarg]+2;
+				if( '\0' == *opt.iologfile ){
+					fprintf(stderr,"Missing io log file: %s\n", argv[optarg]);
+					return 1;
+				}
+				break;
+			case 'H': if( ! parse_perf(argv[optarg]+2) ){
+					fprintf(stderr,"Invalid perf event list: %s\n", argv[optarg]+2);
+					puthelp();
+					return 1;
+				  }
+				break;
+			case 'e': if( ! parse_engine(argv[optarg]+2) ){
+					fprintf(stderr,"Unknown engine: %s\n", argv[optarg]+2);
+					puthelp();
+					return 1;
+				  }
+				break;
+			default: fprintf(stderr,"Unknown opt: %s\n", argv[optarg]); 
+				puthelp();
+				return 1;
+				break;
+		}
+	}/*end for optarg */
+
+	if( argc < optarg + 3){
+		fprintf(stderr,"Insufficient number of parameters.\n");
+		puthelp();
+		return 1;
+	}
+	
+	if(1>opt.threadcnt){
+		fprintf(stderr,"Threadcount (-t) must be at least 1\n");
+		return 1;
+	}
+	if( ENG_SYNC & opt.engine->flags ){
+		if( ( opt.rawmode && ( ENG_MAP & opt.engine->flags ) ) || opt.poll || opt.nsweepqd ){
+			fprintf(stderr,"The %s engine cannot be combined with -y or -Q%s\n", opt.engine->name,
+				ENG_MAP & opt.engine->flags ? " or -r" : "");
+			return 1;
+		}
+		if( 1 < opt.threadcnt ){
+			fprintf(stderr,"Warn: the %s engine is synchronous, threadcount is 1 (more jobs: -j)\n",
+				opt.engine->name);
+			opt.threadcnt = 1;
+		}
+	}
+	if( NULL != opt.tracefile ){ /* -P: only the replay */
+		if( phaseset || 0 <= opt.readpct || opt.nsweepbs || opt.nsweepqd || opt.nbss ){
+			fprintf(stderr,"The replay (-P) cannot be combined with -p, -m, -b, -B or -Q\n");
+			return 1;
+		}
+		runlist[nrun++] = &replayphase;
+		phaseset = TRUE;
+	}
+	if( opt.meta ){ /* -f: only the metadata workload */
+		if( phaseset || 0 <= opt.readpct || opt.nsweepbs || opt.nsweepqd || opt.nbss ||
+		    opt.nstreams || opt.precond || opt.flushn || opt.flushbytes || opt.discardn ||
+		    opt.verify || opt.rate > 0.0 || opt.poll || NULL != opt.iologfile ){
+			fprintf(stderr,"The metadata workload (-f) cannot be combined with -p, -m, -P, -b, -B, -Q,\n"
+				"-N, -W, -F, -K, -v, -R, -y or -L\n");
+			return 1;
+		}
+		runlist[nrun++] = &metaphase;
+		phaseset = TRUE;
+	}
+	if( ! phaseset ){
+		if( 0 <= opt.readpct ){ /* -m alone: only the mixed phase */
+			runlist[nrun++] = &mixphase;
+			ismixed = 1;
+		}else{
+			runlist[nrun++] = &phases[0];
+		}
+	}
+	if( 0 == nrun ){
+		fprintf(stderr,"No valid phase selected (-p)\n");
+		return 1;
+	}
+	if( ismixed && 0 > opt.readpct ){
+		fprintf(stderr,"The mixed phase (-p5) needs the read percent (-m)\n");
+		return 1;
+	}
+	if(1>opt.njobs){
+		fprintf(stderr,"Jobs (-j) must be at least 1\n");
+		return 1;
+	}
+	
+	opt.fname = strdup(argv[optarg]);
+	if(opt.debug){printf(" filename=%s\n",opt.fname);fflush(stdout);}
+	opt.fnames = (char **)malloc((strlen(opt.fname) + 1) * sizeof(char *));
+	errh_malloc(opt.fnames, "array of targets");
+	opt.ntargets = 0;
+	for( ca = strtok(strdup(opt.fname), ","); NULL != ca; ca = strtok(NULL, ",") )
+		opt.fnames[opt.ntargets++] = ca;
+	if( 0 == opt.ntargets ){
+		fprintf(stderr," Invalid filename (%s)\n", opt.fname);
+		return 1;
+	}
+	if( NULL != opt.iologfile && opt.ntargets > UINT16_MAX + 1 ){
+		fprintf(stderr,"The per io log (-L) can tell at most %d targets apart\n", UINT16_MAX + 1);
+		return 1;
+	}
+	if( opt.meta && ( 1 != opt.ntargets || 0 != stat(opt.fnames[0], &st) || ! S_ISDIR(st.st_mode) ) ){
+		fprintf(stderr,"The metadata workload (-f) needs one directory as target: %s\n", opt.fname);
+		return 1;
+	}
+	opt.tgtblk = (char *)calloc(opt.ntargets, sizeof(char));
+	errh_malloc(opt.tgtblk, "array of target types");
+	/* the wrapped offsets of the replay: O_DIRECT needs the logical block size */
+	opt.replayalign = opt.rawmode ? 4096 : 512;
+	for( i = 0; i < opt.ntargets; i++ ){
+		opt.tgtblk[i] = 0 == stat(opt.fnames[i], &st) && S_ISBLK(st.st_mode);
+		fd = opt.tgtblk[i] && opt.rawmode ? open(opt.fnames[i], O_RDONLY) : -1;
+		if( 0 <= fd ){
+			if( 0 == ioctl(fd, BLKSSZGET, &lbs) && (unsigned long long)lbs > opt.replayalign )
+				opt.replayalign = lbs;
+			close(fd);
+		}
+	}
+	if( opt.align > opt.replayalign ) opt.replayalign = opt.align;
+	if( opt.iopoll && ( ! opt.rawmode || opt.flushn || opt.flushbytes || opt.discardn ) ){
+		fprintf(stderr,"The iopoll needs -r, and it cannot be combined with -F or -K\n");
+		return 1;
+	}
+	if( opt.zoned && ( 1 != opt.ntargets || ! opt.tgtblk[0] || ! opt.rawmode || opt.discardn ||
+	    NULL != opt.tracefile || opt.meta || ( ENG_MAP & opt.engine->flags ) ) ){
+		fprintf(stderr,"The zoned mode (-z) needs one block device and -r, it cannot be combined\n"
+			"with -K, -P, -f or the mmap engine\n");
+		return 1;
+	}
+	if( opt.zoned && opt.runtimens && ! opt.zreset ){
+		fprintf(stderr,"The time based runs (-T) on zones need the reset of the full zones (-z...,reset)\n");
+		return 1;
+	}
+	if( opt.discardn && opt.verify ){
+		fprintf(stderr,"The discard (-K) cannot be combined with the verify (-v)\n");
+		return 1;
+	}
+	optarg++;
+	
+	opt.mbl = atol( argv[optarg] );
+	if( 0 >= opt.mbl){
+		fprintf(stderr," Invalid blocksize (%s)\n",argv[optarg]);
+		return 1;
+	}
+	opt.blocksize = opt.mbl;
+	if(opt.debug){printf(" blocksize=%lld\n",opt.mbl);fflush(stdout);}
+	optarg++;
+
+	opt.datasize = atoint64(argv[optarg]);
+	if( opt.datasize <= 0 ){
+		fprintf(stderr," Invalid datasize (%lld != %s)\n",
+				opt.datasize, argv[optarg]);
+		return 1;
+	}
+	if(opt.debug){printf(" datasize=%lld\n",opt.datasize);fflush(stdout);}
+	
+	if( opt.datasize % opt.mbl != 0 ){
+		if(lazy){
+			if(opt.debug)printf(" datasize was rounded up:%lld ->",
+					opt.datasize);
+			opt.datasize = (opt.datasize/opt.mbl +1LL) * opt.mbl;
+			if(opt.debug){printf("%lld\n", opt.datasize); fflush(stdout);}
+		}else{
+			fprintf(stderr,"Err: datasize is not multiple of blocksize\n");
+			return 1;
+		}
+	}
+	if( opt.nbss ){ /* the mean io size: the iocount and the slices */
+		if( opt.nsweepbs ){
+			fprintf(stderr,"The bssplit (-b) cannot be combined with -B\n");
+			return 1;
+		}
+		maxbs = w = 0;
+		for( i = 0; i < opt.nbss; i++ ){
+			w += opt.bss[i] * (opt.bsscum[i] - ( i ? opt.bsscum[i - 1] : 0 ));
+			if( opt.bss[i] > maxbs ) maxbs = opt.bss[i];
+		}
+		opt.mbl = ( w / opt.bsscum[opt.nbss - 1] + 511 ) / 512 * 512;
+		if( 0 == opt.align ) opt.align = 4096;
+		if(opt.debug){printf(" bssplit: mean io size %lld\n",opt.mbl);fflush(stdout);}
+	}
+	if( opt.align % 4096 && ( opt.verify || opt.uncompressable || opt.compress > 0.0 || opt.dedup > 0.0 ) ){
+		/* the stamps and the generated data are per 4 KiB block of the device */
+		fprintf(stderr,"Error: -A%llu with -v, -u, -C or -X: the alignment has to be a multiple of 4 KiB\n", 
+			opt.align);
+		return 1;
+	}
+	if( opt.nsweepbs || opt.nsweepqd ){
+		if( 0 == opt.nsweepbs ){ /* only -Q: the blocksize parameter */
+			opt.sweepbs[0] = opt.mbl;
+			opt.nsweepbs = 1;
+		}
+		if( 0 == opt.nsweepqd ){ /* only -B: the -t */
+			opt.sweepqd[0] = opt.threadcnt;
+			opt.nsweepqd = 1;
+		}
+		if( 0 == opt.runtimens ) opt.runtimens = 10000000000ULL;
+		opt.mbl = opt.sweepbs[0]; /* for the checks below */
+		for( i = 0; i < opt.nsweepbs; i++ ){
+			if( opt.sweepbs[i] > opt.mbl ) opt.mbl = opt.sweepbs[i];
+		}
+		opt.datasize -= opt.datasize % opt.mbl;
+		for( i = 0; i < opt.nsweepqd; i++ ){
+			if( (long long)opt.sweepqd[i] > opt.threadcnt ) opt.threadcnt = opt.sweepqd[i];
+		}
+	}
+	opt.totio = opt.datasize/opt.mbl;
+	if( NULL != opt.tracefile ) /* the records of the trace */
+		opt.totio = sub_tracescan();
+	if(opt.debug){printf(" total ios=%lld\n",opt.totio);fflush(stdout);}
+	if( opt.njobs > opt.totio){
+		fprintf(stderr,"Err: to small datasize, less ios than jobs\n");
+		return 1;
+	}
+	if( opt.threadcnt > opt.totio / opt.njobs){
+		opt.threadcnt = opt.totio / opt.njobs;
+		fprintf(stderr,
+			"Warn: to small datasize, threadcount shrink down to %lld\n", 
+			opt.threadcnt);
+	}
+	opt.bufsize = opt.mbl > opt.maxreclen ? opt.mbl : opt.maxreclen;
+	if( maxbs > opt.bufsize ) opt.bufsize = maxbs;
+	opt.nbufs = opt.threadcnt;
+
+	if( opt.zoned ) sub_zones();
+
+	opt.rndfh = open(opt.randompool, O_RDONLY);
+	if( opt.rndfh <0 ){
+		fprintf(stderr, "Error opening '%s'", opt.randompool);
+		perror(" ");
+		exit(1) ;
+	}
+	if( ! seedset ){ /* the only read of the pool for the offsets */
+		status=read(opt.rndfh, &opt.seed, sizeof(opt.seed) );
+		if( sizeof(opt.seed) != status ) 
+			errh_iogeneric("read( randomfile )", -errno);
+	}
+	if(opt.debug){printf(" seed=%llu\n",opt.seed);fflush(stdout);}
+	if( opt.compress > 0.0 || opt.dedup > 0.0 ){
+		pattern_init(&opt.pattern, opt.seed, opt.compress > 0.0 ? opt.compress : 1.0,
+			opt.dedup, (opt.datasize + PATTERN_BLOCK - 1) / PATTERN_BLOCK);
+		if(opt.debug){printf(" pattern: %u random bytes per block, %llu distinct blocks\n",
+			opt.pattern.rndlen, (unsigned long long)opt.pattern.nuniq);fflush(stdout);}
+	}
+
+	if( opt.arena ){ /* one slice of nbufs buffers per job */
+		opt.devnode = arena_devnode(opt.fnames[0]);
+		if( -2 == opt.arenanode && 0 > opt.devnode )
+			fprintf(stderr, "Warn: the numa node of '%s' is unknown, the arena is not bound\n", opt.fnames[0]);
+		status = arena_create(&opt.bufarena, opt.njobs * opt.nbufs * roundup4k(opt.bufsize),
+			opt.arenapage, -2 == opt.arenanode ? opt.devnode : opt.arenanode);
+		if( status ){
+			fprintf(stderr, "Error: cannot create the buffer arena: %s\n", strerror(-status));
+			return 1;
+		}
+		if( opt.bufarena.fallback )
+			fprintf(stderr, "Warn: no hugetlb pages (vm.nr_hugepages), the arena is on 4 KiB pages\n");
+		if(opt.debug){printf(" arena: %zu bytes at %p, page %zu, node %d\n", opt.bufarena.size,
+			opt.bufarena.base, opt.bufarena.pagesize, opt.bufarena.node);fflush(stdout);}
+	}
+
+	opt.jobs = (struct iojob *)calloc(opt.njobs, sizeof(struct iojob));
+	errh_malloc(opt.jobs, "array of jobs");
+	for( i=0 ; i < opt.njobs ; i ++ ){
+		opt.jobs[i].id = i;
+		opt.jobs[i].cpu = opt.ncpus ? opt.cpus[i % opt.ncpus] : -1;
+		opt.jobs[i].ranoncpu = opt.jobs[i].ranonnode = -1;
+		opt.jobs[i].fhs = (int *)calloc(opt.ntargets, sizeof(int));
+		errh_malloc(opt.jobs[i].fhs, "array of file handles");
+		/* the buffers are allocated by the job itself, see alloc_buffers() */
 	}
 
 	/*
@@ -565,30 +4450,37 @@ int main(int argc, char* argv[])
 
 
 	
-	gettimeofday(&starttime, NULL);
-	printf("{\"start\":%ld.%06ld, \"threadcount\":%lld, \"blocksize\":%lld, \"iocount\":%lld, ", 
-            starttime.tv_sec, starttime.tv_usec,
-            opt.threadcnt, opt.mbl, opt.totio);
-    fflush(stdout);
+	mixphase.readpct = opt.readpct;
+	mixphase.rndread = ! opt.mixseqread;
+	mixphase.rndwrite = ! opt.mixseqwrite;
+	if( opt.precond && ! sub_precondition() )
+		return 3;
+	if( NULL != opt.iologfile ) iolog_start();
 
-	if(isseqwrite){
-        printf("\"type\":\"seqwrite\", ");
-        fflush(stdout);
-		sub_doio(FALSE, O_WRONLY);
-	}else if(isrndwrite){
-        printf("\"type\":\"rndwrite\", ");
-        fflush(stdout);
-		sub_doio(TRUE, O_WRONLY);
-	}else if(isseqread){
-        printf("\"type\":\"seqread\", ");
-        fflush(stdout);
-		sub_doio(FALSE, O_RDONLY);
-	}else if(isrndread){
-        printf("\"type\":\"rndread\", ");
-        fflush(stdout);
-		sub_doio(TRUE, O_RDONLY);
-	}
-    printf("}\n");
-    fflush(stdout);	
-    return 0;
+	if( 1 == nrun ){
+		sub_phase(runlist[0], stdout);
+		printf("\n");
+	}else{
+		/* 
+		 * collected, and printed at the end in one line: the interval 
+		 * reports cannot get into the array 
+		 */
+		out = open_memstream(&results, &resultslen);
+		errh_malloc(out, "result stream");
+		fprintf(out, "[");
+		for( i = 0; i < nrun; i++ ){
+			if( i ){
+				fprintf(out, ", ");
+				sub_betweenphases();
+			}
+			sub_phase(runlist[i], out);
+		}
+		fprintf(out, "]\n");
+		fclose(out);
+		fputs(results, stdout);
+		free(results);
+	}
+	if( NULL != opt.iologfile ) iolog_stop();
+    fflush(stdout);
+    return opt.badblocks ? 2 : 0;
 }
@@ -0,0 +1,139 @@
+/* iolog.h
+**
+**	Author: Adam Maulis
+**	2026.10.17
+**	Copyright: GNU AGPL v3 or newer
+**
+**
+**	Description: per io log record and single producer / single consumer
+**	ring, data type & member functions
+**
+**	File format: IOLOG_HEADER bytes of header (IOLOG_MAGIC, record size,
+**	the rest is zero), then the iolog_rec_t records (little endian), so
+**	the writer can write in large aligned chunks.
+**
+**	The ring is lock free: the producer (the io job) owns head, the
+**	consumer (the writer thread) owns tail. A full ring does not block
+**	the producer, the record is dropped (and counted by the caller).
+**
+**	Build notes:
+**	header only, used by fillone.c and iologstat.c
+*/
+
+#ifndef __IOLOG_H
+#define __IOLOG_H
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define IOLOG_MAGIC "FOIOLOG2"	/* 2: 16 bit target */
+#define IOLOG_HEADER 4096
+
+/* op of the records */
+#define IOLOG_READ 0
+#define IOLOG_WRITE 1
+#define IOLOG_FLUSH 2
+#define IOLOG_DISCARD 3
+
+typedef struct {
+		uint64_t submitns;	/* monotonic clock (open loop: the scheduled time) */
+		uint64_t completens;
+		uint64_t offset;	/* bytes, on the target */
+		uint32_t len;		/* bytes */
+		int32_t res;		/* bytes or -errno */
+		uint16_t job;
+		uint16_t target;	/* index in the targets of fillone */
+		uint8_t op;		/* IOLOG_* */
+		uint8_t phase;		/* the result objects of fillone in order, from 0 */
+		uint8_t pad[2];
+	} iolog_rec_t;
+
+typedef struct {
+		iolog_rec_t * recs;
+		uint64_t mask;		/* number of the records - 1 */
+		uint64_t head;		/* written by the producer */
+		char pad[64 - sizeof(uint64_t)];	/* head and tail in other cache lines */
+		uint64_t tail;		/* written by the consumer */
+	} iolog_ring_t;
+
+/* nrecs: power of 2, returns 0 or -ENOMEM */
+static inline int iolog_ring_init( iolog_ring_t * r, uint64_t nrecs )
+{
+	memset( r, 0, sizeof(*r) );
+	r->recs = (iolog_rec_t *)calloc(nrecs, sizeof(iolog_rec_t));
+	if( NULL == r->recs ) return -ENOMEM;
+	r->mask = nrecs - 1;
+	return 0;
+}
+
+static inline void iolog_ring_free( iolog_ring_t * r )
+{
+	free(r->recs);
+	r->recs = NULL;
+}
+
+/* producer side, returns 0 if the ring is full (the record is dropped) */
+static inline int iolog_push( iolog_ring_t * r, const iolog_rec_t * rec )
+{
+	uint64_t head = r->head;
+
+	if( head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) > r->mask )
+		return 0;
+	r->recs[head & r->mask] = *rec;
+	__atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+/* consumer side, at most max records into dst, returns their number */
+static inline uint64_t iolog_pop( iolog_ring_t * r, iolog_rec_t * dst, uint64_t max )
+{
+	uint64_t tail = r->tail;
+	uint64_t n, first;
+
+	n = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) - tail;
+	if( n > max ) n = max;
+	if( 0 == n ) return 0;
+	first = r->mask + 1 - ( tail & r->mask ); /* till the end of the array */
+	if( first > n ) first = n;
+	memcpy( dst, &r->recs[tail & r->mask], first * sizeof(iolog_rec_t) );
+	memcpy( dst + first, r->recs, ( n - first ) * sizeof(iolog_rec_t) );
+	__atomic_store_n(&r->tail, tail + n, __ATOMIC_RELEASE);
+	return n;
+}
+
+/* the header into buf (IOLOG_HEADER bytes) */
+static inline void iolog_header( char * buf )
+{
+	uint32_t recsize = sizeof(iolog_rec_t);
+
+	memset( buf, 0, IOLOG_HEADER );
+	memcpy( buf, IOLOG_MAGIC, sizeof(IOLOG_MAGIC) - 1 );
+	memcpy( buf + sizeof(IOLOG_MAGIC) - 1, &recsize, sizeof(recsize) );
+}
+
+/* returns the record size from the header, 0 if it is not an iolog */
+static inline uint32_t iolog_checkheader( const char * buf, size_t len )
+{
+	uint32_t recsize;
+
+	if( len < IOLOG_HEADER || memcmp(buf, IOLOG_MAGIC, sizeof(IOLOG_MAGIC) - 1) )
+		return 0;
+	memcpy( &recsize, buf + sizeof(IOLOG_MAGIC) - 1, sizeof(recsize) );
+	return recsize;
+}
+
+static inline const char * iolog_opname( unsigned op )
+{
+	switch( op ){
+		case IOLOG_READ: return "read";
+		case IOLOG_WRITE: return "write";
+		case IOLOG_FLUSH: return "flush";
+		case IOLOG_DISCARD: return "discard";
+		default: return "unknown";
+	}
+}
+
+#endif /* __IOLOG_H */
@@ -0,0 +1,263 @@
+/*
+ * Author: Maulis Adam
+ * Description:
+ *    statistics of the per io log of fillone (-L): latency histograms per
+ *    operation, and heatmap of the latency over the offset (or the time)
+ *
+ *    The heatmap is a matrix of io counts: a row is a slice of the offsets
+ *    (or of the run time), a column is a latency range, the upper edges of
+ *    the ranges are powers of two in microseconds. The flushes have no
+ *    offset, they are only in the time heatmap.
+ *
+ * initial release: 17-oct-2026
+ *
+ * to build:
+ * cc -O2 -o iologstat -Wall iologstat.c
+ *
+ * usage:
+ * fillone -L/other/disk/sdb.iolog ... /dev/sdb 4096 1g
+ * iologstat [-p#] [-t#] [-o<rwfd>] [-m#[,time]] /other/disk/sdb.iolog
+
+ Copyright by Adam Maulis 2026
+
+ This program is free software: you can redistribute it and/or modify it under
+ the terms of the GNU Affero General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ See the GNU Affero General Public License for more details.
+
+ */
+
+#define VERS "0.1"  /* update please! */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "lathist.h"
+#include "iolog.h"
+
+#ifndef TRUE
+#define TRUE (0==0)
+#endif
+#ifndef FALSE
+#define FALSE (0!=0)
+#endif
+#define NOPS 4		/* IOLOG_READ .. IOLOG_DISCARD */
+#define MAXCOLS 64
+
+static struct {
+	int phase;	/* -1: all */
+	int target;	/* -1: all */
+	int ops[NOPS];	/* selected */
+	long rows;	/* heatmap, 0: none */
+	int bytime;	/* heatmap rows over the time, not the offset */
+	const iolog_rec_t * recs;
+	unsigned long long nrecs;
+}opt;
+
+static struct {
+	lathist_t lat[NOPS];
+	unsigned long long bytes[NOPS];
+	unsigned long long errors[NOPS];
+	unsigned long long selected;
+	unsigned long long minofs, maxofs;	/* of the selected ios, maxofs: the end */
+	unsigned long long firstns, lastns;	/* submit and complete */
+	unsigned long long maxlatns;
+}st;
+
+static inline int selected(const iolog_rec_t * r)
+{
+	return r->op < NOPS && opt.ops[r->op] &&
+		( 0 > opt.phase || r->phase == opt.phase ) &&
+		( 0 > opt.target || r->target == opt.target );
+}
+
+static inline unsigned long long latns(const iolog_rec_t * r)
+{
+	return r->completens > r->submitns ? r->completens - r->submitns : 0;
+}
+
+/* the column of the heatmap: the upper edge is 2^col microseconds */
+static inline int latcol(unsigned long long ns)
+{
+	unsigned long long us = ns / 1000;
+	int col;
+
+	col = us ? 64 - __builtin_clzll(us) : 0;
+	return col < MAXCOLS ? col : MAXCOLS - 1;
+}
+
+/* first pass: the histograms and the ranges for the heatmap */
+void scan(void)
+{
+	const iolog_rec_t * r;
+	unsigned long long i, ns;
+	int op;
+
+	for( op = 0; op < NOPS; op++ )
+		lathist_init(&st.lat[op]);
+	st.minofs = st.firstns = ~0ULL;
+	for( i = 0; i < opt.nrecs; i++ ){
+		r = &opt.recs[i];
+		if( ! selected(r) ) continue;
+		ns = latns(r);
+		lathist_record(&st.lat[r->op], ns);
+		if( 0 > r->res ) st.errors[r->op]++;
+		else st.bytes[r->op] += r->res;
+		st.selected++;
+		if( IOLOG_FLUSH != r->op && r->offset < st.minofs ) st.minofs = r->offset;
+		if( IOLOG_FLUSH != r->op && r->offset + r->len > st.maxofs ) st.maxofs = r->offset + r->len;
+		if( r->submitns < st.firstns ) st.firstns = r->submitns;
+		if( r->completens > st.lastns ) st.lastns = r->completens;
+		if( ns > st.maxlatns ) st.maxlatns = ns;
+	}
+}
+
+/* second pass: the heatmap */
+void heatmap(void)
+{
+	unsigned long long * cells;
+	unsigned long long from, span, step, i, row, v;
+	const iolog_rec_t * r;
+	int ncols, c;
+
+	ncols = latcol(st.maxlatns) + 1;
+	from = opt.bytime ? st.firstns : st.minofs;
+	span = opt.bytime ? st.lastns - st.firstns : st.maxofs - st.minofs;
+	step = span / opt.rows + 1;
+	cells = (unsigned long long *)calloc(opt.rows * ncols, sizeof(unsigned long long));
+	if( NULL == cells ){
+		fprintf(stderr,"Error: no memory for the heatmap\n");
+		exit(1);
+	}
+	for( i = 0; i < opt.nrecs; i++ ){
+		r = &opt.recs[i];
+		if( ! selected(r) ) continue;
+		if( ! opt.bytime && IOLOG_FLUSH == r->op ) continue; /* no offset */
+		v = opt.bytime ? r->submitns : r->offset;
+		row = ( v - from ) / step;
+		cells[row * ncols + latcol(latns(r))]++;
+	}
+	printf(", \"heatmap\":{\"rows\":\"%s\", \"from\":%llu, \"step\":%llu, \"lat_us_upper\":[",
+		opt.bytime ? "time_ns" : "offset", opt.bytime ? 0ULL : from, step);
+	for( c = 0; c < ncols; c++ )
+		printf("%s%llu", c ? ", " : "", 1ULL << c);
+	printf("], \"counts\":[");
+	for( row = 0; row < (unsigned long long)opt.rows; row++ ){
+		printf("%s[", row ? ", " : "");
+		for( c = 0; c < ncols; c++ )
+			printf("%s%llu", c ? ", " : "", cells[row * ncols + c]);
+		printf("]");
+	}
+	printf("]}");
+	free(cells);
+}
+
+void puthelp(void)
+{
+	fprintf(stderr,"iologstat version %s copyright by Maulis Adam 2026, using AGPL v3 or newer\n\n", VERS);
+	fprintf(stderr,"Usage: iologstat [options] iologfile  (written by fillone -L)\n");
+	fprintf(stderr,"   -p# only the ios of this result object of fillone (from 0, like the json array)\n");
+	fprintf(stderr,"   -t# only the ios of this target (from 0)\n");
+	fprintf(stderr,"   -o<rwfd> only these operations: read, write, flush, discard (default: all)\n");
+	fprintf(stderr,"   -m#[,time] heatmap of the latency with # rows over the offset (or the time)\n");
+}
+
+int main(int argc, char* argv[])
+{
+	int optarg;
+	const char * ca;
+	char * map;
+	struct stat sb;
+	uint32_t recsize;
+	int fd, op, any;
+
+	opt.phase = opt.target = -1;
+	for( op = 0; op < NOPS; op++ )
+		opt.ops[op] = TRUE;
+	for(optarg=1;  optarg < argc && argv[optarg][0] == '-'; optarg++ ){
+		switch( argv[optarg][1] ){
+			case 'p': opt.phase = atoi(argv[optarg]+2);
+				break;
+			case 't': opt.target = atoi(argv[optarg]+2);
+				break;
+			case 'o': for( op = 0; op < NOPS; op++ )
+					opt.ops[op] = FALSE;
+				  for( ca = argv[optarg]+2; *ca; ca++ ){
+					switch( *ca ){
+						case 'r': opt.ops[IOLOG_READ] = TRUE; break;
+						case 'w': opt.ops[IOLOG_WRITE] = TRUE; break;
+						case 'f': opt.ops[IOLOG_FLUSH] = TRUE; break;
+						case 'd': opt.ops[IOLOG_DISCARD] = TRUE; break;
+						default: fprintf(stderr,"Invalid operation: %c\n", *ca);
+							return 1;
+					}
+				  }
+				break;
+			case 'm': opt.rows = atol(argv[optarg]+2);
+				  opt.bytime = NULL != strstr(argv[optarg], ",time");
+				  if( 0 >= opt.rows ){
+					fprintf(stderr,"Invalid heatmap rows: %s\n", argv[optarg]+2);
+					return 1;
+				  }
+				break;
+			default: fprintf(stderr,"Unknown opt: %s\n", argv[optarg]);
+				puthelp();
+				return 1;
+		}
+	}
+	if( optarg + 1 != argc ){
+		puthelp();
+		return 1;
+	}
+
+	fd = open(argv[optarg], O_RDONLY);
+	if( 0 > fd || 0 > fstat(fd, &sb) ){
+		fprintf(stderr,"Cannot open %s", argv[optarg]);
+		perror(" ");
+		return 1;
+	}
+	if( sb.st_size < IOLOG_HEADER ){
+		fprintf(stderr,"Error: %s is not an io log of fillone\n", argv[optarg]);
+		return 1;
+	}
+	map = (char *)mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if( MAP_FAILED == map ){
+		perror("Error: mmap");
+		return 1;
+	}
+	madvise(map, sb.st_size, MADV_SEQUENTIAL);
+	recsize = iolog_checkheader(map, sb.st_size);
+	if( sizeof(iolog_rec_t) != recsize ){
+		fprintf(stderr,"Error: %s is not an io log of this version of fillone\n", argv[optarg]);
+		return 1;
+	}
+	opt.recs = (const iolog_rec_t *)(map + IOLOG_HEADER);
+	opt.nrecs = ( sb.st_size - IOLOG_HEADER ) / sizeof(iolog_rec_t);
+
+	scan();
+	printf("{\"records\":%llu, \"selected\":%llu, \"span\":%f, \"ops\":[", opt.nrecs, st.selected,
+		st.selected ? (double)(st.lastns - st.firstns) / 1e9 : 0.0);
+	for( any = FALSE, op = 0; op < NOPS; op++ ){
+		if( 0 == st.lat[op].cnt ) continue;
+		printf("%s{\"op\":\"%s\", \"ios\":%llu, \"bytes\":%llu, \"errors\":%llu, ", any ? ", " : "",
+			iolog_opname(op), (unsigned long long)st.lat[op].cnt, st.bytes[op], st.errors[op]);
+		lathist_print(stdout, "lat_us", &st.lat[op]);
+		printf("}");
+		any = TRUE;
+	}
+	printf("]");
+	if( opt.rows && st.selected && ( opt.bytime || st.maxofs ) )
+		heatmap();
+	printf("}\n");
+	munmap(map, sb.st_size);
+	close(fd);
+	return 0;
+}
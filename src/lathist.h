@@ -0,0 +1,183 @@
+/* lathist.h
+**
+**	Author: Adam Maulis
+**	2026.10.17
+**	Copyright: GNU AGPL v3 or newer
+**
+**
+**	Description: log-linear (HDR-style) latency histogram data type
+**	& member functions
+**
+**	Every power of two is split into LATH_SUB linear sub-buckets, so the
+**	relative error of a reported value is below 1/LATH_SUB (1.6%) over
+**	the whole 64 bit range. Recording is a clz, a shift and an increment.
+**
+**	There is one writer per histogram. Its stores are relaxed atomics
+**	(plain moves on x86 and arm64), so an other thread can take a
+**	consistent-enough snapshot with lathist_snapmerge() while it records:
+**	every value is whole and never goes back, only the fields may be from
+**	slightly different moments.
+**
+**	Build notes:
+**	header only, used by fillone.c
+*/
+
+#ifndef __LATHIST_H
+#define __LATHIST_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#define LATH_SUBBITS 6
+#define LATH_SUB (1 << LATH_SUBBITS)
+#define LATH_BUCKETS ((64 - LATH_SUBBITS + 1) * LATH_SUB)
+
+typedef struct {
+		uint64_t cnt;
+		uint64_t sum;	/* for the mean */
+		uint64_t min;
+		uint64_t max;
+		uint64_t bucket[LATH_BUCKETS];
+	} lathist_t;
+
+static inline void lathist_init( lathist_t * h )
+{
+	memset( h, 0, sizeof(*h) );
+	h->min = UINT64_MAX;
+}
+
+static inline unsigned lathist_index( uint64_t v )
+{
+	int shift;
+
+	if( v < LATH_SUB ) return (unsigned)v; /* exact below LATH_SUB */
+	shift = 63 - __builtin_clzll(v) - LATH_SUBBITS;
+	return (unsigned)( (shift + 1) * LATH_SUB + (v >> shift) - LATH_SUB );
+}
+
+/* the highest value falling into the bucket 'idx' */
+static inline uint64_t lathist_value( unsigned idx )
+{
+	int shift;
+
+	if( idx < LATH_SUB ) return idx;
+	shift = idx / LATH_SUB - 1;
+	return ( ( (uint64_t)(idx % LATH_SUB + LATH_SUB + 1) ) << shift ) - 1;
+}
+
+/* the lowest value falling into the bucket 'idx' */
+static inline uint64_t lathist_lowvalue( unsigned idx )
+{
+	int shift;
+
+	if( idx < LATH_SUB ) return idx;
+	shift = idx / LATH_SUB - 1;
+	return ( (uint64_t)(idx % LATH_SUB + LATH_SUB) ) << shift;
+}
+
+static inline void lathist_record( lathist_t * h, uint64_t v )
+{
+	unsigned i = lathist_index(v);
+
+	__atomic_store_n( &h->bucket[i], h->bucket[i] + 1, __ATOMIC_RELAXED );
+	__atomic_store_n( &h->cnt, h->cnt + 1, __ATOMIC_RELAXED );
+	__atomic_store_n( &h->sum, h->sum + v, __ATOMIC_RELAXED );
+	if( v < h->min ) __atomic_store_n( &h->min, v, __ATOMIC_RELAXED );
+	if( v > h->max ) __atomic_store_n( &h->max, v, __ATOMIC_RELAXED );
+}
+
+static inline void lathist_merge( lathist_t * dst, const lathist_t * src )
+{
+	unsigned i;
+
+	if( 0 == src->cnt ) return;
+	for( i = 0; i < LATH_BUCKETS; i++ )
+		dst->bucket[i] += src->bucket[i];
+	dst->cnt += src->cnt;
+	dst->sum += src->sum;
+	if( src->min < dst->min ) dst->min = src->min;
+	if( src->max > dst->max ) dst->max = src->max;
+}
+
+/*
+** like lathist_merge(), but src is being recorded by an other thread:
+** the counter is the sum of the buckets read, so they agree
+*/
+static inline void lathist_snapmerge( lathist_t * dst, const lathist_t * src )
+{
+	uint64_t b, min, max;
+	unsigned i;
+
+	for( i = 0; i < LATH_BUCKETS; i++ ){
+		b = __atomic_load_n( &src->bucket[i], __ATOMIC_RELAXED );
+		dst->bucket[i] += b;
+		dst->cnt += b;
+	}
+	dst->sum += __atomic_load_n( &src->sum, __ATOMIC_RELAXED );
+	min = __atomic_load_n( &src->min, __ATOMIC_RELAXED );
+	max = __atomic_load_n( &src->max, __ATOMIC_RELAXED );
+	if( min < dst->min ) dst->min = min;
+	if( max > dst->max ) dst->max = max;
+}
+
+/*
+** d = cur - prev, where cur is a later state of the same histogram as prev.
+** min and max are known only with the precision of the buckets. A bucket
+** (or the sum) behind prev gives 0, not a wrapped around difference.
+*/
+static inline void lathist_diff( lathist_t * d, const lathist_t * cur, const lathist_t * prev )
+{
+	unsigned i;
+
+	lathist_init(d);
+	for( i = 0; i < LATH_BUCKETS; i++ ){
+		d->bucket[i] = cur->bucket[i] > prev->bucket[i] ? cur->bucket[i] - prev->bucket[i] : 0;
+		if( 0 == d->bucket[i] ) continue;
+		if( 0 == d->cnt ) d->min = lathist_lowvalue(i);
+		d->max = lathist_value(i);
+		d->cnt += d->bucket[i];
+	}
+	if( d->cnt && cur->sum > prev->sum ) d->sum = cur->sum - prev->sum;
+}
+
+/* p is in percent (0..100) */
+static inline uint64_t lathist_percentile( const lathist_t * h, double p )
+{
+	uint64_t rank, seen;
+	unsigned i;
+
+	if( 0 == h->cnt ) return 0;
+	rank = (uint64_t)( p / 100.0 * (double)h->cnt + 0.5 );
+	if( rank < 1 ) rank = 1;
+	if( rank > h->cnt ) rank = h->cnt;
+	for( seen = 0, i = 0; i < LATH_BUCKETS; i++ ){
+		seen += h->bucket[i];
+		if( seen >= rank ) break;
+	}
+	if( i >= LATH_BUCKETS ) return h->max;
+	/* the bucket edge may stick out of the observed range */
+	if( lathist_value(i) > h->max ) return h->max;
+	if( lathist_value(i) < h->min ) return h->min;
+	return lathist_value(i);
+}
+
+/*
+** prints '"name":{...}' in microseconds, the values are recorded in nanoseconds
+*/
+static inline void lathist_print( FILE * f, const char * name, const lathist_t * h )
+{
+	fprintf(f, "\"%s\":{\"min\":%.3f, \"mean\":%.3f, \"p50\":%.3f, \"p90\":%.3f, "
+		"\"p99\":%.3f, \"p99.9\":%.3f, \"p99.99\":%.3f, \"max\":%.3f}",
+		name,
+		h->cnt ? (double)h->min / 1000.0 : 0.0,
+		h->cnt ? (double)h->sum / (double)h->cnt / 1000.0 : 0.0,
+		(double)lathist_percentile(h, 50.0) / 1000.0,
+		(double)lathist_percentile(h, 90.0) / 1000.0,
+		(double)lathist_percentile(h, 99.0) / 1000.0,
+		(double)lathist_percentile(h, 99.9) / 1000.0,
+		(double)lathist_percentile(h, 99.99) / 1000.0,
+		(double)h->max / 1000.0);
+}
+
+#endif /* __LATHIST_H */
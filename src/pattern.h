@@ -0,0 +1,152 @@
+/* pattern.h
+**
+**	Author: Adam Maulis
+**	2026.10.17
+**	Copyright: GNU AGPL v3 or newer
+**
+**
+**	Description: data pattern generator with a target compression and
+**	dedup ratio, data type & member functions
+**
+**	The unit is the 4 KiB block. Every block gets a key (the dedup
+**	identity), the same key gives the same content. The first
+**	4096/compress bytes of the block are pseudo random (8 xorshift32
+**	lanes, gcc vector extension, only shifts and xors), the rest is zero,
+**	so a block compressor sees about the requested ratio.
+**
+**	Build notes:
+**	header only, used by fillone.c
+*/
+
+#ifndef __PATTERN_H
+#define __PATTERN_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PATTERN_BLOCK 4096
+#define PATTERN_VEC 32 /* bytes of one generator step */
+
+typedef uint32_t pattern_v8_t __attribute__((vector_size(PATTERN_VEC)));
+
+typedef struct {
+		uint64_t seed;	/* mixed into every key: other seed, other data */
+		unsigned rndlen;	/* random bytes at the start of every block */
+		uint64_t nuniq;	/* number of the distinct blocks, 0: all distinct */
+	} pattern_t;
+
+/*
+** compress, dedup: the target ratios (>= 1.0),
+** nblocks: the 4 KiB blocks of the area where the dedup ratio should hold
+*/
+static inline void pattern_init( pattern_t * p, uint64_t seed,
+				double compress, double dedup, uint64_t nblocks )
+{
+	unsigned len;
+
+	p->seed = seed;
+	len = (unsigned)( (double)PATTERN_BLOCK / compress + 0.5 );
+	len = ( len + PATTERN_VEC - 1 ) / PATTERN_VEC * PATTERN_VEC;
+	if( len < PATTERN_VEC ) len = PATTERN_VEC;
+	if( len > PATTERN_BLOCK ) len = PATTERN_BLOCK;
+	p->rndlen = len;
+	p->nuniq = 0;
+	if( dedup > 1.0 ){
+		p->nuniq = (uint64_t)( (double)nblocks / dedup + 0.5 );
+		if( 0 == p->nuniq ) p->nuniq = 1;
+	}
+}
+
+/* the key of the 4 KiB block 'blockno' */
+static inline uint64_t pattern_key( const pattern_t * p, uint64_t blockno )
+{
+	return p->nuniq ? blockno % p->nuniq : blockno;
+}
+
+static inline uint64_t pattern_splitmix( uint64_t * x )
+{
+	uint64_t z = ( *x += 0x9E3779B97F4A7C15ULL );
+
+	z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+	z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+	return z ^ ( z >> 31 );
+}
+
+/* the generator state of the block of 'key' */
+static inline void pattern_lanes( const pattern_t * p, uint64_t key, pattern_v8_t * x )
+{
+	uint64_t sm, v;
+	unsigned i;
+
+	sm = key ^ p->seed;
+	for( i = 0; i < 8; i += 2 ){
+		v = pattern_splitmix(&sm) | 0x0000000100000001ULL; /* no zero lane */
+		(*x)[i] = (uint32_t)v;
+		(*x)[i + 1] = (uint32_t)( v >> 32 );
+	}
+}
+
+/*
+** the first min(len, rndlen) bytes of the block of 'key' into dst,
+** the zero tail is not written: it is the caller's job, once per buffer
+*/
+static inline void pattern_fill( const pattern_t * p, char * dst, unsigned len, uint64_t key )
+{
+	pattern_v8_t x;
+	unsigned i;
+
+	pattern_lanes(p, key, &x);
+	if( len > p->rndlen ) len = p->rndlen;
+	for( i = 0; i < len; i += PATTERN_VEC ){
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		if( i + PATTERN_VEC <= len )
+			memcpy( dst + i, &x, PATTERN_VEC );
+		else
+			memcpy( dst + i, &x, len - i );
+	}
+	if( len >= sizeof(key) )
+		memcpy( dst, &key, sizeof(key) ); /* stamp */
+}
+
+/*
+** compares len bytes at src with the block of 'key' (stamp, random part
+** and zero tail), returns 0 if they are the same
+*/
+static inline int pattern_check( const pattern_t * p, const char * src, unsigned len, uint64_t key )
+{
+	pattern_v8_t x, e, y, diff;
+	unsigned i, rnd;
+
+	pattern_lanes(p, key, &x);
+	diff = x ^ x;
+	rnd = len < p->rndlen ? len : p->rndlen;
+	for( i = 0; i < rnd; i += PATTERN_VEC ){
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		e = x;
+		if( 0 == i && rnd >= sizeof(key) ){ /* stamp */
+			e[0] = (uint32_t)key;
+			e[1] = (uint32_t)( key >> 32 );
+		}
+		if( i + PATTERN_VEC <= rnd ){
+			memcpy( &y, src + i, PATTERN_VEC );
+			diff |= y ^ e;
+		} else if( memcmp( src + i, &e, rnd - i ) ){
+			return 1;
+		}
+	}
+	for( i = rnd; i + PATTERN_VEC <= len; i += PATTERN_VEC ){
+		memcpy( &y, src + i, PATTERN_VEC );
+		diff |= y;
+	}
+	for( ; i < len; i++ )
+		if( src[i] ) return 1;
+	for( i = 1; i < 8; i++ )
+		diff[0] |= diff[i];
+	return 0 != diff[0];
+}
+
+#endif /* __PATTERN_H */
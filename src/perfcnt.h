@@ -0,0 +1,153 @@
+/* perfcnt.h
+**
+**	Author: Adam Maulis
+**	2026.10.17
+**	Copyright: GNU AGPL v3 or newer
+**
+**
+**	Description: hardware (and software) counters of the calling thread
+**	through perf_event_open(2), data type & member functions
+**
+**	Every counter is an own event (not a group), so one event the cpu
+**	does not know does not spoil the others. The values are scaled by
+**	time_enabled/time_running when the kernel multiplexed the counters.
+**	If the kernel side is not allowed (perf_event_paranoid), the counters
+**	are opened again for the user space only.
+**
+**	Build notes:
+**	header only, used by fillone.c
+*/
+
+#ifndef __PERFCNT_H
+#define __PERFCNT_H
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define PERFCNT_MAX 8
+
+typedef struct {
+		int n;
+		int ev[PERFCNT_MAX];	/* index in perfcnt_events[] */
+		int fd[PERFCNT_MAX];	/* -1: the event could not be opened */
+		uint64_t val[PERFCNT_MAX];
+		int valid[PERFCNT_MAX];	/* val[] is counted */
+		int useronly;		/* the kernel is excluded */
+	} perfcnt_t;
+
+static const struct {
+		const char * name;
+		uint32_t type;
+		uint64_t config;
+	} perfcnt_events[] = {
+		{ "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+		{ "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+		{ "cache-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+		{ "cache-references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+		{ "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+		{ "page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+		{ "cpu-migrations", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS },
+		{ NULL, 0, 0 }
+	};
+
+/* index in perfcnt_events[], or -1 */
+static inline int perfcnt_lookup( const char * name, size_t len )
+{
+	int i;
+
+	for( i = 0; NULL != perfcnt_events[i].name; i++ )
+		if( len == strlen(perfcnt_events[i].name) && 0 == strncmp(name, perfcnt_events[i].name, len) )
+			return i;
+	return -1;
+}
+
+static inline int perfcnt_open1( int ev, int useronly )
+{
+	struct perf_event_attr attr;
+
+	memset( &attr, 0, sizeof(attr) );
+	attr.size = sizeof(attr);
+	attr.type = perfcnt_events[ev].type;
+	attr.config = perfcnt_events[ev].config;
+	attr.disabled = 1;
+	attr.exclude_hv = 1;
+	attr.exclude_kernel = useronly ? 1 : 0;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0); /* this thread, any cpu */
+}
+
+static inline void perfcnt_close( perfcnt_t * p )
+{
+	int i;
+
+	for( i = 0; i < p->n; i++ ){
+		if( 0 <= p->fd[i] ) close(p->fd[i]);
+		p->fd[i] = -1;
+	}
+}
+
+/*
+** events: n indexes in perfcnt_events[]
+** returns 0 if at least one counter is open, or -errno of the first one
+*/
+static inline int perfcnt_open( perfcnt_t * p, const int * events, int n )
+{
+	int i, err = 0, nopen = 0;
+
+	memset( p, 0, sizeof(*p) );
+	p->n = n > PERFCNT_MAX ? PERFCNT_MAX : n;
+	for( i = 0; i < p->n; i++ )
+		p->fd[i] = -1;
+	for( i = 0; i < p->n; i++ ){
+		p->ev[i] = events[i];
+		p->fd[i] = perfcnt_open1(events[i], p->useronly);
+		if( 0 > p->fd[i] && ( EACCES == errno || EPERM == errno ) && ! p->useronly ){
+			perfcnt_close(p); /* all of them user only, to be comparable */
+			p->useronly = 1;
+			i = -1;
+			continue;
+		}
+		if( 0 > p->fd[i] ){
+			if( 0 == err ) err = -errno;
+		}else{
+			nopen++;
+		}
+	}
+	return nopen ? 0 : err;
+}
+
+static inline void perfcnt_start( perfcnt_t * p )
+{
+	int i;
+
+	for( i = 0; i < p->n; i++ ){
+		if( 0 > p->fd[i] ) continue;
+		ioctl(p->fd[i], PERF_EVENT_IOC_RESET, 0);
+		ioctl(p->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+	}
+}
+
+/* stops the counters and reads them into p->val[] */
+static inline void perfcnt_stop( perfcnt_t * p )
+{
+	uint64_t rd[3]; /* value, time_enabled, time_running */
+	int i;
+
+	for( i = 0; i < p->n; i++ ){
+		p->val[i] = 0;
+		p->valid[i] = 0;
+		if( 0 > p->fd[i] ) continue;
+		ioctl(p->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+		if( sizeof(rd) != read(p->fd[i], rd, sizeof(rd)) || 0 == rd[2] )
+			continue;
+		p->val[i] = rd[2] < rd[1] ? (uint64_t)( (double)rd[0] * rd[1] / rd[2] ) : rd[0];
+		p->valid[i] = 1;
+	}
+}
+
+#endif /* __PERFCNT_H */
@@ -0,0 +1,170 @@
+/* trace.h
+**
+**	Author: Adam Maulis
+**	2026.10.17
+**	Copyright: GNU AGPL v3 or newer
+**
+**
+**	Description: block io trace data type & member functions
+**
+**	Two formats, told apart by the first 8 bytes:
+**	- binary: TRACE_MAGIC, then trace_rec_t records (little endian)
+**	- csv: one io per line: time_sec,offset,length,op[,latency_us]
+**	  (op: R or W, offset and length in bytes, '#' lines are comments)
+**
+**	The reader maps the file and goes through it once, the pages behind
+**	the cursor are given back, so a trace does not need to fit in RAM.
+**
+**	Build notes:
+**	header only, used by fillone.c and blk2trace.c
+*/
+
+#ifndef __TRACE_H
+#define __TRACE_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TRACE_MAGIC "FOTRACE1"
+#define TRACE_READ 0	/* the same as DIR_READ of fillone */
+#define TRACE_WRITE 1
+#define TRACE_RELEASE (64ULL << 20) /* give back the pages after this many bytes */
+
+typedef struct {
+		uint64_t ns;		/* issue time */
+		uint64_t offset;	/* bytes */
+		uint64_t latns;		/* original latency, 0: unknown */
+		uint32_t len;		/* bytes */
+		uint32_t op;		/* TRACE_READ or TRACE_WRITE */
+	} trace_rec_t;
+
+typedef struct {
+		int fd;
+		char * map;
+		size_t size;
+		size_t pos;		/* of the next record */
+		size_t released;	/* the pages before this are given back */
+		int binary;
+		unsigned long line;	/* csv: for the error messages */
+	} trace_t;
+
+/* returns 0 or -errno */
+static inline int trace_open( trace_t * t, const char * path )
+{
+	struct stat st;
+	int err;
+
+	memset( t, 0, sizeof(*t) );
+	t->fd = open(path, O_RDONLY);
+	if( 0 > t->fd ) return -errno;
+	if( 0 > fstat(t->fd, &st) ) goto err_close;
+	t->size = st.st_size;
+	if( 0 == t->size ){
+		close(t->fd);
+		return -ENODATA;
+	}
+	t->map = (char *)mmap(NULL, t->size, PROT_READ, MAP_PRIVATE, t->fd, 0);
+	if( MAP_FAILED == t->map ) goto err_close;
+	madvise(t->map, t->size, MADV_SEQUENTIAL);
+	t->binary = t->size >= sizeof(TRACE_MAGIC) - 1 &&
+		0 == memcmp(t->map, TRACE_MAGIC, sizeof(TRACE_MAGIC) - 1);
+	t->pos = t->binary ? sizeof(TRACE_MAGIC) - 1 : 0;
+	return 0;
+
+err_close:
+	err = -errno;
+	close(t->fd);
+	return err;
+}
+
+static inline void trace_close( trace_t * t )
+{
+	munmap(t->map, t->size);
+	close(t->fd);
+	t->map = NULL;
+	t->fd = -1;
+}
+
+static inline void trace_rewind( trace_t * t )
+{
+	t->pos = t->binary ? sizeof(TRACE_MAGIC) - 1 : 0;
+	t->released = 0;
+	t->line = 0;
+}
+
+/* csv: one line into r, returns 1, 0 for the empty and comment lines, -EINVAL */
+static inline int trace_parseline( const char * line, trace_rec_t * r )
+{
+	double sec, latus = 0.0;
+	unsigned long long offset, len;
+	char op;
+	int n;
+
+	while( ' ' == *line || '\t' == *line ) line++;
+	if( '\0' == *line || '#' == *line ) return 0;
+	n = sscanf(line, "%lf ,%llu ,%llu , %c ,%lf", &sec, &offset, &len, &op, &latus);
+	if( n < 4 || sec < 0.0 || 0 == len || len > UINT32_MAX || latus < 0.0 )
+		return -EINVAL;
+	switch( op ){
+		case 'R': case 'r': r->op = TRACE_READ; break;
+		case 'W': case 'w': r->op = TRACE_WRITE; break;
+		default: return -EINVAL;
+	}
+	r->ns = (uint64_t)( sec * 1e9 + 0.5 );
+	r->offset = offset;
+	r->len = (uint32_t)len;
+	r->latns = (uint64_t)( latus * 1e3 + 0.5 );
+	return 1;
+}
+
+/* the next record into r, returns 1, 0 at the end, or -EINVAL */
+static inline int trace_next( trace_t * t, trace_rec_t * r )
+{
+	char line[256];
+	const char * eol;
+	size_t len;
+	int status;
+
+	if( t->pos - t->released >= TRACE_RELEASE ){
+		madvise(t->map + t->released, t->pos / 4096 * 4096 - t->released, MADV_DONTNEED);
+		t->released = t->pos / 4096 * 4096;
+	}
+	if( t->binary ){
+		if( t->pos + sizeof(*r) > t->size ) return 0;
+		memcpy( r, t->map + t->pos, sizeof(*r) );
+		t->pos += sizeof(*r);
+		return ( TRACE_READ == r->op || TRACE_WRITE == r->op ) && 0 < r->len ? 1 : -EINVAL;
+	}
+	for( ; t->pos < t->size; ){
+		eol = memchr(t->map + t->pos, '\n', t->size - t->pos);
+		len = ( NULL == eol ? t->map + t->size : eol ) - ( t->map + t->pos );
+		if( len >= sizeof(line) ) return -EINVAL;
+		memcpy( line, t->map + t->pos, len );
+		line[len] = '\0';
+		t->pos += len + 1;
+		t->line++;
+		status = trace_parseline(line, r);
+		if( 0 != status ) return status;
+	}
+	return 0;
+}
+
+/* the binary writer: TRACE_MAGIC once, then the records */
+static inline int trace_writeheader( FILE * f )
+{
+	return 1 == fwrite(TRACE_MAGIC, sizeof(TRACE_MAGIC) - 1, 1, f) ? 0 : -EIO;
+}
+
+static inline int trace_write( FILE * f, const trace_rec_t * r )
+{
+	return 1 == fwrite(r, sizeof(*r), 1, f) ? 0 : -EIO;
+}
+
+#endif /* __TRACE_H */
@@ -0,0 +1,234 @@
+/* uring.h
+**
+**	Author: Adam Maulis
+**	2026.10.17
+**	Copyright: GNU AGPL v3 or newer
+**
+**
+**	Description: minimal io_uring data type & member functions on top of
+**	the raw syscalls (no liburing needed, only the kernel uapi header)
+**
+**	The functions return 0 or a positive count on success and -errno on
+**	failure, like libaio does, so the same error handlers can be used.
+**
+**	Build notes:
+**	header only, used by fillone.c, needs linux >= 5.6 at runtime
+**	(5.11 for the wait with timeout)
+*/
+
+#ifndef __URING_H
+#define __URING_H
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+typedef struct {
+		int fd;
+		unsigned flags;		/* IORING_SETUP_* */
+		/* submission ring */
+		unsigned * sq_head;
+		unsigned * sq_tail;
+		unsigned * sq_mask;
+		unsigned * sq_flags;
+		unsigned * sq_array;
+		unsigned sq_entries;
+		unsigned sqe_tail;	/* local, published by uring_submit() */
+		struct io_uring_sqe * sqes;
+		/* completion ring */
+		unsigned * cq_head;
+		unsigned * cq_tail;
+		unsigned * cq_mask;
+		struct io_uring_cqe * cqes;
+		/* mappings */
+		void * sq_ptr;
+		void * cq_ptr;
+		size_t sq_sz;
+		size_t cq_sz;
+		size_t sqes_sz;
+		unsigned long long enters;	/* io_uring_enter() calls, for the statistics */
+	} uring_t;
+
+static inline int uring_enter( uring_t * r, unsigned to_submit,
+				unsigned min_complete, unsigned flags )
+{
+	long ret;
+
+	r->enters++;
+	ret = syscall(__NR_io_uring_enter, r->fd, to_submit, min_complete,
+			flags, NULL, 0);
+	return ret < 0 ? -errno : (int)ret;
+}
+
+static inline int uring_register( uring_t * r, unsigned opcode,
+				const void * arg, unsigned nr_args )
+{
+	long ret;
+
+	ret = syscall(__NR_io_uring_register, r->fd, opcode, arg, nr_args);
+	return ret < 0 ? -errno : 0;
+}
+
+static inline void uring_exit( uring_t * r )
+{
+	if( NULL != r->sqes ) munmap(r->sqes, r->sqes_sz);
+	if( NULL != r->cq_ptr && r->cq_ptr != r->sq_ptr ) munmap(r->cq_ptr, r->cq_sz);
+	if( NULL != r->sq_ptr ) munmap(r->sq_ptr, r->sq_sz);
+	if( 0 <= r->fd ) close(r->fd);
+	memset( r, 0, sizeof(*r) );
+	r->fd = -1;
+}
+
+/*
+** flags: IORING_SETUP_* (for example IORING_SETUP_SQPOLL)
+*/
+static inline int uring_init( uring_t * r, unsigned entries, unsigned flags )
+{
+	struct io_uring_params p;
+	unsigned i;
+	int err;
+
+	memset( r, 0, sizeof(*r) );
+	memset( &p, 0, sizeof(p) );
+	p.flags = flags;
+	if( flags & IORING_SETUP_SQPOLL )
+		p.sq_thread_idle = 1000; /* ms before the kernel thread sleeps */
+	r->fd = syscall(__NR_io_uring_setup, entries, &p);
+	if( 0 > r->fd ) return -errno;
+	r->flags = flags;
+
+	r->sq_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	r->cq_sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if( p.features & IORING_FEAT_SINGLE_MMAP ){
+		if( r->cq_sz > r->sq_sz ) r->sq_sz = r->cq_sz;
+		r->cq_sz = r->sq_sz;
+	}
+	r->sq_ptr = mmap(NULL, r->sq_sz, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+	if( MAP_FAILED == r->sq_ptr ) goto err_map;
+	if( p.features & IORING_FEAT_SINGLE_MMAP ){
+		r->cq_ptr = r->sq_ptr;
+	} else {
+		r->cq_ptr = mmap(NULL, r->cq_sz, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+		if( MAP_FAILED == r->cq_ptr ){
+			r->cq_ptr = NULL;
+			goto err_map;
+		}
+	}
+	r->sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+	r->sqes = mmap(NULL, r->sqes_sz, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+	if( MAP_FAILED == r->sqes ){
+		r->sqes = NULL;
+		goto err_map;
+	}
+
+	r->sq_head  = (unsigned *)((char *)r->sq_ptr + p.sq_off.head);
+	r->sq_tail  = (unsigned *)((char *)r->sq_ptr + p.sq_off.tail);
+	r->sq_mask  = (unsigned *)((char *)r->sq_ptr + p.sq_off.ring_mask);
+	r->sq_flags = (unsigned *)((char *)r->sq_ptr + p.sq_off.flags);
+	r->sq_array = (unsigned *)((char *)r->sq_ptr + p.sq_off.array);
+	r->sq_entries = p.sq_entries;
+	r->sqe_tail = *r->sq_tail;
+	r->cq_head  = (unsigned *)((char *)r->cq_ptr + p.cq_off.head);
+	r->cq_tail  = (unsigned *)((char *)r->cq_ptr + p.cq_off.tail);
+	r->cq_mask  = (unsigned *)((char *)r->cq_ptr + p.cq_off.ring_mask);
+	r->cqes = (struct io_uring_cqe *)((char *)r->cq_ptr + p.cq_off.cqes);
+
+	/* sqe index == ring index, the indirection array is never touched again */
+	for( i = 0; i < r->sq_entries; i++ )
+		r->sq_array[i] = i;
+	return 0;
+
+err_map:
+	err = -errno;
+	if( MAP_FAILED == r->sq_ptr ) r->sq_ptr = NULL;
+	uring_exit(r);
+	return err;
+}
+
+/* returns NULL if the submission ring is full */
+static inline struct io_uring_sqe * uring_get_sqe( uring_t * r )
+{
+	struct io_uring_sqe * sqe;
+
+	if( r->sqe_tail - __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE) >= r->sq_entries )
+		return NULL;
+	sqe = &r->sqes[r->sqe_tail & *r->sq_mask];
+	r->sqe_tail++;
+	memset( sqe, 0, sizeof(*sqe) );
+	return sqe;
+}
+
+/*
+** publishes the prepared sqes. With SQPOLL there is no syscall at all,
+** unless the kernel thread went to sleep or we want to wait for completions.
+** returns the number of submitted sqes or -errno
+*/
+static inline int uring_submit( uring_t * r, unsigned wait_nr )
+{
+	unsigned to_submit;
+	unsigned flags = 0;
+	int ret;
+
+	to_submit = r->sqe_tail - *r->sq_tail;
+	__atomic_store_n(r->sq_tail, r->sqe_tail, __ATOMIC_RELEASE);
+	if( wait_nr ) flags |= IORING_ENTER_GETEVENTS;
+	if( r->flags & IORING_SETUP_SQPOLL ){
+		__atomic_thread_fence(__ATOMIC_SEQ_CST); /* tail store vs. flags load */
+		if( __atomic_load_n(r->sq_flags, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP )
+			flags |= IORING_ENTER_SQ_WAKEUP;
+		if( 0 == flags ) return to_submit;
+		ret = uring_enter(r, to_submit, wait_nr, flags);
+		return ret < 0 ? ret : (int)to_submit;
+	}
+	return uring_enter(r, to_submit, wait_nr, flags);
+}
+
+/* waits for at least wait_nr completions */
+static inline int uring_wait( uring_t * r, unsigned wait_nr )
+{
+	return uring_enter(r, 0, wait_nr, IORING_ENTER_GETEVENTS);
+}
+
+/*
+** waits for at least wait_nr completions, but not longer than ts
+** returns -ETIME on timeout (linux >= 5.11)
+*/
+static inline int uring_wait_timeout( uring_t * r, unsigned wait_nr,
+				const struct timespec * ts )
+{
+	struct io_uring_getevents_arg arg;
+	struct __kernel_timespec kts;
+	long ret;
+
+	kts.tv_sec = ts->tv_sec;
+	kts.tv_nsec = ts->tv_nsec;
+	memset( &arg, 0, sizeof(arg) );
+	arg.ts = (unsigned long)&kts;
+	r->enters++;
+	ret = syscall(__NR_io_uring_enter, r->fd, 0, wait_nr,
+			IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+	return ret < 0 ? -errno : (int)ret;
+}
+
+/* returns NULL if there is no completion in the ring */
+static inline struct io_uring_cqe * uring_peek_cqe( uring_t * r )
+{
+	unsigned head = *r->cq_head;
+
+	if( head == __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE) )
+		return NULL;
+	return &r->cqes[head & *r->cq_mask];
+}
+
+static inline void uring_cqe_seen( uring_t * r )
+{
+	__atomic_store_n(r->cq_head, *r->cq_head + 1, __ATOMIC_RELEASE);
+}
+
+#endif /* __URING_H */
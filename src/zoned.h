@@ -0,0 +1,111 @@
+/* zoned.h
+**
+**	Author: Adam Maulis
+**	2026.10.17
+**	Copyright: GNU AGPL v3 or newer
+**
+**
+**	Description: zones of a zoned block device (ZNS, SMR), through the
+**	BLKREPORTZONE and BLKRESETZONE ioctls, data type & member functions
+**
+**	The kernel counts in 512 byte sectors, zone_t in bytes. The write
+**	pointer of a full zone is set to the end of its capacity, so the free
+**	space of every zone is start + cap - wp.
+**
+**	For a local test, null_blk can emulate a zoned device:
+**	modprobe null_blk nr_devices=1 zoned=1 zone_size=64 zone_nr_conv=4 \
+**		memory_backed=1 gb=4
+**
+**	Build notes:
+**	header only, used by fillone.c; linux >= 5.9 (zone capacity)
+*/
+
+#ifndef __ZONED_H
+#define __ZONED_H
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <linux/blkzoned.h>
+
+#define ZONED_BATCH 256	/* zones per BLKREPORTZONE call */
+
+typedef struct {
+		uint64_t start;		/* bytes */
+		uint64_t len;
+		uint64_t cap;		/* writable bytes from start */
+		uint64_t wp;		/* write pointer */
+		uint32_t no;		/* number of the zone on the device */
+		uint8_t type;		/* BLK_ZONE_TYPE_* */
+		uint8_t cond;		/* BLK_ZONE_COND_* */
+	} zone_t;
+
+/* number of the zones, 0 if the device is not zoned */
+static inline unsigned zoned_count( int fd )
+{
+	uint32_t n = 0;
+
+	if( ioctl(fd, BLKGETNRZONES, &n) ) return 0;
+	return n;
+}
+
+/* at most n zones into z, returns their number or -errno */
+static inline long zoned_report( int fd, zone_t * z, unsigned n )
+{
+	struct blk_zone_report * rep;
+	struct blk_zone * bz = NULL;
+	uint64_t sector = 0;
+	unsigned i, got = 0;
+	int err;
+
+	rep = (struct blk_zone_report *)malloc(sizeof(*rep) + ZONED_BATCH * sizeof(struct blk_zone));
+	if( NULL == rep ) return -ENOMEM;
+	while( got < n ){
+		memset( rep, 0, sizeof(*rep) );
+		rep->sector = sector;
+		rep->nr_zones = ZONED_BATCH;
+		if( ioctl(fd, BLKREPORTZONE, rep) ){
+			err = -errno;
+			free(rep);
+			return err;
+		}
+		if( 0 == rep->nr_zones ) break;
+		for( i = 0; i < rep->nr_zones && got < n; i++, got++ ){
+			bz = &rep->zones[i];
+			z[got].start = bz->start << 9;
+			z[got].len = bz->len << 9;
+			z[got].cap = ( BLK_ZONE_REP_CAPACITY & rep->flags ) ? bz->capacity << 9 : z[got].len;
+			z[got].wp = BLK_ZONE_COND_FULL == bz->cond ? z[got].start + z[got].cap : bz->wp << 9;
+			z[got].no = got;
+			z[got].type = bz->type;
+			z[got].cond = bz->cond;
+		}
+		sector = bz->start + bz->len;
+	}
+	free(rep);
+	return got;
+}
+
+/* the write pointer back to the start, returns 0 or -errno */
+static inline int zoned_reset( int fd, zone_t * z )
+{
+	struct blk_zone_range range;
+
+	range.sector = z->start >> 9;
+	range.nr_sectors = z->len >> 9;
+	if( ioctl(fd, BLKRESETZONE, &range) ) return -errno;
+	z->wp = z->start;
+	z->cond = BLK_ZONE_COND_EMPTY;
+	return 0;
+}
+
+/* a sequential write zone that can be written (and reset) */
+static inline int zoned_seqwritable( const zone_t * z )
+{
+	return BLK_ZONE_TYPE_CONVENTIONAL != z->type &&
+		BLK_ZONE_COND_READONLY != z->cond && BLK_ZONE_COND_OFFLINE != z->cond;
+}
+
+#endif /* __ZONED_H */
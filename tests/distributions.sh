@@ -0,0 +1,44 @@
+#!/bin/sh
+#
+# Author: Maulis Adam
+# Description:
+#    regression test: the random offset distributions (-d). 2048 random
+#    writes on 2048 blocks, the offsets are read from the per io log (-L):
+#    uniform hits about 63% of the blocks, zipf (theta 0.99) much less of
+#    them, and hot:90:10 sends about 90% of the ios to the first 10%.
+#
+# usage (from the top of the repo):
+# sh tests/distributions.sh
+#
+# Copyright by Adam Maulis 2026, GNU AGPL v3 or newer
+
+set -e
+SRC=$(dirname "$0")/../src
+T=$(mktemp -d)
+trap 'rm -rf "$T"' EXIT
+
+${CC:-cc} -O2 -Wall $CFLAGS -o "$T/fillone" "$SRC/fillone.c" $LDFLAGS -laio -lm -lpthread
+dd if=/dev/zero of="$T/f8" bs=1M count=8 status=none
+
+# the offsets of the ios: iolog_rec_t is 40 bytes after a 4 KiB header, the 3rd u64
+offsets(){
+	"$T/fillone" -s1 -d"$1" -p2 -t4 -L"$T/$1.log" "$T/f8" 4096 8388608 > /dev/null
+	od -An -v -j4096 -t u8 -w40 "$T/$1.log" | awk '{ print $3 }'
+}
+
+uniq_uniform=$(offsets uniform | sort -u | wc -l)
+uniq_zipf=$(offsets zipf | sort -u | wc -l)
+if [ "$uniq_uniform" -lt 1200 ] || [ "$uniq_uniform" -gt 1400 ]; then
+	echo "FAIL: uniform hit $uniq_uniform blocks of 2048 (instead of about 1295)"
+	exit 1
+fi
+if [ $((2 * uniq_zipf)) -gt "$uniq_uniform" ]; then
+	echo "FAIL: zipf hit $uniq_zipf blocks, not much less than the $uniq_uniform of uniform"
+	exit 1
+fi
+hotpct=$(offsets hot:90:10 | awk '{ n++; if( $1 < 838861 ) h++ } END{ printf "%d", 100 * h / n }')
+if [ "$hotpct" -lt 85 ] || [ "$hotpct" -gt 95 ]; then
+	echo "FAIL: hot:90:10 sent $hotpct% of the ios to the first 10%"
+	exit 1
+fi
+echo "OK"
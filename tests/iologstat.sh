@@ -0,0 +1,44 @@
+#!/bin/sh
+#
+# Author: Maulis Adam
+# Description:
+#    regression test: iologstat on the per io log (-L) of a two phase run
+#    (-p1 -p4, 2 jobs, 1024 ios each). The whole log, the phase (-p) and
+#    op (-o) selection, and the io count of the offset heatmap (-m) are
+#    checked against the ios of fillone.
+#
+# usage (from the top of the repo):
+# sh tests/iologstat.sh
+#
+# Copyright by Adam Maulis 2026, GNU AGPL v3 or newer
+
+set -e
+SRC=$(dirname "$0")/../src
+T=$(mktemp -d)
+trap 'rm -rf "$T"' EXIT
+
+${CC:-cc} -O2 -Wall $CFLAGS -o "$T/fillone" "$SRC/fillone.c" $LDFLAGS -laio -lm -lpthread
+${CC:-cc} -O2 -Wall $CFLAGS -o "$T/iologstat" "$SRC/iologstat.c"
+dd if=/dev/zero of="$T/f8" bs=1M count=8 status=none
+
+"$T/fillone" -j2 -t4 -p1 -p4 -L"$T/run.log" "$T/f8" 4096 4194304 > "$T/out.json"
+if ! "$T/iologstat" "$T/run.log" > "$T/all.json" ||
+   ! grep -q '^{"records":2048, "selected":2048, ' "$T/all.json" ||
+   ! grep -q '{"op":"read", "ios":1024, "bytes":4194304, "errors":0, ' "$T/all.json" ||
+   ! grep -q '{"op":"write", "ios":1024, "bytes":4194304, "errors":0, ' "$T/all.json"; then
+	echo "FAIL: iologstat does not have the 1024 writes and 1024 reads of the run"
+	exit 1
+fi
+"$T/iologstat" -p0 -ow "$T/run.log" > "$T/p0w.json"
+"$T/iologstat" -p0 -or "$T/run.log" > "$T/p0r.json"
+if ! grep -q '"selected":1024, ' "$T/p0w.json" || ! grep -q '"selected":0, ' "$T/p0r.json"; then
+	echo "FAIL: the phase and op selection of iologstat"
+	exit 1
+fi
+"$T/iologstat" -p1 -m4 "$T/run.log" > "$T/heat.json"
+if [ 1024 != "$(sed 's/.*"counts":\[\(.*\)\]}}/\1/' "$T/heat.json" | tr -c '0-9\n' ' ' |
+    awk '{ for( i = 1; i <= NF; i++ ) n += $i } END{ print n }')" ]; then
+	echo "FAIL: the heatmap of the read phase does not have 1024 ios"
+	exit 1
+fi
+echo "OK"
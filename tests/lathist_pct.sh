@@ -0,0 +1,71 @@
+#!/bin/sh
+#
+# Author: Maulis Adam
+# Description:
+#    regression test: the percentiles of the latency histogram (lathist.h).
+#    The values 1..1000000 ns (uniform) go into a histogram, every reported
+#    percentile has to be within the 1/LATH_SUB (1.6%) error of the exact
+#    one; then the lat_us of a fillone run has to be ordered
+#    (min <= p50 <= ... <= p99.99 <= max).
+#
+# usage (from the top of the repo):
+# sh tests/lathist_pct.sh
+#
+# Copyright by Adam Maulis 2026, GNU AGPL v3 or newer
+
+set -e
+SRC=$(dirname "$0")/../src
+T=$(mktemp -d)
+trap 'rm -rf "$T"' EXIT
+
+cat > "$T/pct.c" <<'EOF'
+#include <stdlib.h>
+#include "lathist.h"
+
+int main(void)
+{
+	static const double pcts[] = { 50.0, 90.0, 99.0, 99.9, 99.99 };
+	lathist_t * h = (lathist_t *)malloc(sizeof(lathist_t));
+	lathist_t * m = (lathist_t *)malloc(sizeof(lathist_t));
+	uint64_t v, got;
+	double want;
+	unsigned i;
+
+	if( NULL == h || NULL == m ) return 1;
+	lathist_init(h);
+	lathist_init(m);
+	for( v = 1; v <= 1000000; v++ )
+		lathist_record(h, v);
+	lathist_merge(m, h); /* the merged one of fillone */
+	if( 1 != m->min || 1000000 != m->max || 1000000 != m->cnt ){
+		printf("min %llu max %llu cnt %llu\n", (unsigned long long)m->min,
+			(unsigned long long)m->max, (unsigned long long)m->cnt);
+		return 1;
+	}
+	for( i = 0; i < sizeof(pcts) / sizeof(pcts[0]); i++ ){
+		want = pcts[i] / 100.0 * 1000000.0;
+		got = lathist_percentile(m, pcts[i]);
+		if( (double)got < want * (1.0 - 1.0 / LATH_SUB) || (double)got > want * (1.0 + 1.0 / LATH_SUB) ){
+			printf("p%g: %llu instead of %.0f\n", pcts[i], (unsigned long long)got, want);
+			return 1;
+		}
+	}
+	return 0;
+}
+EOF
+${CC:-cc} -O2 -Wall -I"$SRC" -o "$T/pct" "$T/pct.c"
+if ! "$T/pct"; then
+	echo "FAIL: lathist percentiles out of the error bound"
+	exit 1
+fi
+
+${CC:-cc} -O2 -Wall $CFLAGS -o "$T/fillone" "$SRC/fillone.c" $LDFLAGS -laio -lm -lpthread
+dd if=/dev/zero of="$T/f8" bs=1M count=8 status=none
+"$T/fillone" -p4 -t4 "$T/f8" 4096 8388608 > "$T/out.json"
+if ! sed 's/.*"lat_us":{\([^}]*\)}.*/\1/' "$T/out.json" | tr ',' '\n' |
+    awk -F: 'BEGIN{ prev = -1 } { if( $2 + 0 < prev ) bad = 1; if( $1 !~ /mean/ ) prev = $2 + 0 }
+	END{ exit( bad || 7 != NR - 1 ) }'; then
+	echo "FAIL: the percentiles in lat_us are not ordered"
+	exit 1
+fi
+echo "OK"
@@ -0,0 +1,35 @@
+#!/bin/sh
+#
+# Author: Maulis Adam
+# Description:
+#    regression test: preconditioning (-W) together with the per io log (-L).
+#    The preconditioning runs before the log writer is started, its ios must
+#    not go into the log: fillone must not crash, and the log holds exactly
+#    the ios of the measured phase (-p4: 8 MiB / 4 KiB = 2048 records).
+#
+# usage (from the top of the repo):
+# sh tests/precond_iolog.sh
+#
+# Copyright by Adam Maulis 2026, GNU AGPL v3 or newer
+
+set -e
+SRC=$(dirname "$0")/../src
+T=$(mktemp -d)
+trap 'rm -rf "$T"' EXIT
+
+${CC:-cc} -O2 -Wall $CFLAGS -o "$T/fillone" "$SRC/fillone.c" $LDFLAGS -laio -lm -lpthread
+${CC:-cc} -O2 -Wall $CFLAGS -o "$T/iologstat" "$SRC/iologstat.c"
+dd if=/dev/zero of="$T/f8" bs=1M count=8 status=none
+
+rc=0
+"$T/fillone" -W1,round=0.2,window=2,tol=90,max=4 -L"$T/pc.log" -p4 -t4 \
+	"$T/f8" 4096 8388608 > "$T/out.json" || rc=$?
+if [ 0 != $rc ] && [ 3 != $rc ]; then	# 3: no steady state, still a valid run
+	echo "FAIL: fillone -W -L exited with $rc"
+	exit 1
+fi
+if ! "$T/iologstat" "$T/pc.log" | grep -q '"records":2048,'; then
+	echo "FAIL: the log has not only the 2048 ios of the measured phase"
+	exit 1
+fi
+echo "OK"
@@ -0,0 +1,41 @@
+#!/bin/sh
+#
+# Author: Maulis Adam
+# Description:
+#    regression test: the knee point of the sweep (-B, -Q, -k). Every
+#    blocksize of the sweep has one knee at one of the swept threadcounts,
+#    and the knee is taken on the latency given by -k: p99 by default,
+#    p99.9 or the mean on request (the latency key of the knee follows it).
+#
+# usage (from the top of the repo):
+# sh tests/sweep_knee.sh
+#
+# Copyright by Adam Maulis 2026, GNU AGPL v3 or newer
+
+set -e
+SRC=$(dirname "$0")/../src
+T=$(mktemp -d)
+trap 'rm -rf "$T"' EXIT
+
+${CC:-cc} -O2 -Wall $CFLAGS -o "$T/fillone" "$SRC/fillone.c" $LDFLAGS -laio -lm -lpthread
+dd if=/dev/zero of="$T/f8" bs=1M count=8 status=none
+
+for k in default p99.9 mean; do
+	case $k in
+		default) karg= ; on=p99 ;;
+		*) karg=-k$k ; on=$k ;;
+	esac
+	"$T/fillone" -B4k,16k -Q1-8 -T0.1 -p4 $karg "$T/f8" 4096 8388608 > "$T/$k.json"
+	if ! grep -q "\"knee_on\":\"$on\", \"knee\":\[" "$T/$k.json"; then
+		echo "FAIL: -k$k: the knee is not on $on"
+		exit 1
+	fi
+	sed 's/.*"knee":\[//' "$T/$k.json" | tr '}' '\n' | grep '"blocksize"' > "$T/$k.knee"
+	if [ 2 != "$(wc -l < "$T/$k.knee")" ] ||
+	   [ 2 != "$(grep -c "\"threadcount\":[1248], .*\"${on}_us\":" "$T/$k.knee")" ]; then
+		echo "FAIL: -k$k: not one knee per blocksize at a swept threadcount"
+		cat "$T/$k.knee"
+		exit 1
+	fi
+done
+echo "OK"
@@ -0,0 +1,55 @@
+#!/bin/sh
+#
+# Author: Maulis Adam
+# Description:
+#    regression test: blkparse output -> blk2trace -> fillone -P replay.
+#    100 synthetic issue/completion pairs (every 4th a write, 200 us each)
+#    go through blk2trace; the replay has to do exactly these ios: the
+#    count, the read/write split, the original latency of the trace, and
+#    the offsets in the per io log (-L) are checked.
+#
+# usage (from the top of the repo):
+# sh tests/trace_replay.sh
+#
+# Copyright by Adam Maulis 2026, GNU AGPL v3 or newer
+
+set -e
+SRC=$(dirname "$0")/../src
+T=$(mktemp -d)
+trap 'rm -rf "$T"' EXIT
+
+${CC:-cc} -O2 -Wall $CFLAGS -o "$T/fillone" "$SRC/fillone.c" $LDFLAGS -laio -lm -lpthread
+${CC:-cc} -O2 -Wall -o "$T/blk2trace" "$SRC/blk2trace.c"
+dd if=/dev/zero of="$T/f8" bs=1M count=8 status=none
+
+# "  8,16   1       12     0.000251231  4242  D   W 2048 + 256 [fio]"
+awk 'BEGIN{ for( i = 0; i < 100; i++ ){
+	t = 0.001 * i; s = i * 7919 % 2048 * 8; rw = i % 4 ? "R" : "W"
+	printf "  8,16   1 %d %.9f 4242  D   %s %d + 8 [fio]\n", 2 * i, t, rw, s
+	printf "  8,16   1 %d %.9f 0  C   %s %d + 8 [0]\n", 2 * i + 1, t + 0.0002, rw, s } }' > "$T/blkparse.txt"
+"$T/blk2trace" < "$T/blkparse.txt" > "$T/bin.trace" 2> /dev/null
+"$T/blk2trace" -c < "$T/blkparse.txt" > "$T/csv.trace" 2> /dev/null
+if [ 100 != "$(grep -vc '^#' "$T/csv.trace")" ]; then
+	echo "FAIL: blk2trace did not make 100 records"
+	exit 1
+fi
+
+"$T/fillone" -P"$T/bin.trace",fast -t4 -L"$T/replay.log" "$T/f8" 4096 8388608 > "$T/out.json"
+if ! grep -q '"type":"replay", .*"ios":100, ' "$T/out.json" ||
+   ! grep -q '"read":{[^}]*"ios":75, ' "$T/out.json" ||
+   ! grep -q '"write":{[^}]*"ios":25, ' "$T/out.json"; then
+	echo "FAIL: the replay did not do the 75 reads and 25 writes of the trace"
+	exit 1
+fi
+if ! grep -q '"orig_lat_us":{"min":200.000, "mean":200.000, ' "$T/out.json"; then
+	echo "FAIL: the original latency of the trace is not 200 us"
+	exit 1
+fi
+# iolog_rec_t: submitns, completens, offset, ... 40 bytes after a 4 KiB header
+grep -v '^#' "$T/csv.trace" | cut -d, -f2 | sort -n > "$T/want"
+od -An -v -j4096 -t u8 -w40 "$T/replay.log" | awk '{ print $3 }' | sort -n > "$T/got"
+if ! cmp -s "$T/want" "$T/got"; then
+	echo "FAIL: the offsets of the replay are not the ones of the trace"
+	exit 1
+fi
+echo "OK"